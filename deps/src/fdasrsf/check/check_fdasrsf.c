@@ -0,0 +1,267 @@
+/* Checks of the sorted interpolation and of the batched and threaded warp
+ * solvers against the functions they replace or call per curve:
+ *   approx:   approx_sorted and approx, for sorted and unsorted points
+ *   spline:   spline_sorted and spline, for sorted and unsorted points
+ *   invert:   invertGamma of the identity, and of the inverse of a warping
+ *   mlogit:   mlogit_warp_grad_batch on threads and mlogit_warp_grad_step
+ *             for each curve, bit for bit, for every step rule
+ *   ocmlogit: ocmlogit_warp_grad_batch on threads and for each curve alone,
+ *             bit for bit, in R^2 and R^3 for every step rule
+ *   ocmcost:  the cost of the ocmlogit results is not below the cost at the
+ *             identity warping and rotation
+ *   fpls:     fpls_warp_grad_step on one thread and on several, bit for bit
+ *
+ * Build and run it by "make check"; it returns the number of failed checks. */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../misc_funcs.h"
+#include "../mlogit_warp_grad.h"
+#include "../ocmlogit_warp_grad.h"
+#include "../fpls_warp_grad.h"
+
+/* Print the result of a check and return 1 if it failed; a NaN error fails */
+static int check_report(const char *name, double err, double tol){
+	int passed = (err <= tol);
+
+	printf("%-9s max error %.3e, tolerance %.1e: %s\n", name, err, tol, passed ? "passed" : "FAILED");
+	return !passed;
+}
+
+/* Largest absolute difference of a and b */
+static double check_maxdiff(int n, const double *a, const double *b){
+	int k;
+	double out = 0;
+
+	for (k=0; k<n; k++)
+		out = fmax(out, fabs(a[k] - b[k]));
+	return out;
+}
+
+/* Uniform random number in [0, 1) */
+static double check_rand(void){
+	return (double)rand() / ((double)RAND_MAX + 1);
+}
+
+/* The warping gam(t) = t + a sin(2 pi t) / (2 pi) on TT points, |a| < 1 */
+static void check_gamma(int TT, double a, double *gam){
+	int k;
+	double t;
+
+	for (k=0; k<TT; k++){
+		t = (double)k / (TT-1);
+		gam[k] = t + a * sin(2*M_PI*t) / (2*M_PI);
+	}
+	gam[TT-1] = 1;
+}
+
+/* approx_sorted and spline_sorted against approx and spline on random data
+ * at sorted points inside and outside of the table, and at unsorted points */
+static void check_sorted(double *errapprox, double *errspline){
+	int n = 50, nu = 200, k, l, r;
+	double *x = malloc(sizeof(double)*(2*n + 5*nu));
+	double *y = x + n, *u = y + n, *v1 = u + nu, *v2 = v1 + nu, *a1 = v2 + nu, *a2 = a1 + nu;
+
+	*errapprox = 0;
+	*errspline = 0;
+	x[0] = 0;
+	y[0] = check_rand();
+	for (k=1; k<n; k++){
+		x[k] = x[k-1] + 0.1 + check_rand();
+		y[k] = check_rand();
+	}
+	for (r=0; r<2; r++){
+		for (l=0; l<nu; l++)
+			u[l] = x[0] - 1 + (x[n-1] - x[0] + 2) * (r == 0 ? (double)l / (nu-1) : check_rand());
+		// ties at the first points
+		u[1] = u[0];
+		for (k=0; k<2; k++){
+			approx(x, y, n, u, a1, nu, k + 1, y[0], y[n-1], 0.5);
+			approx_sorted(x, y, n, u, a2, nu, k + 1, y[0], y[n-1], 0.5);
+			*errapprox = fmax(*errapprox, check_maxdiff(nu, a1, a2));
+		}
+		spline(n, x, y, nu, u, v1);
+		spline_sorted(n, x, y, nu, u, v2);
+		*errspline = fmax(*errspline, check_maxdiff(nu, v1, v2));
+	}
+
+	free(x);
+}
+
+/* invertGamma of the identity is the identity, and the inverse of the
+ * inverse of a warping is the warping up to the interpolation error */
+static double check_invert(int TT){
+	double *gam = malloc(sizeof(double)*3*TT);
+	double *gi = gam + TT, *gii = gi + TT;
+	double err;
+
+	check_gamma(TT, 0, gam);
+	invertGamma(TT, gam, gi);
+	err = check_maxdiff(TT, gam, gi);
+	check_gamma(TT, 0.5, gam);
+	invertGamma(TT, gam, gi);
+	invertGamma(TT, gi, gii);
+	err = fmax(err, check_maxdiff(TT, gam, gii));
+
+	free(gam);
+	return err;
+}
+
+/* mlogit_warp_grad_batch on several threads and mlogit_warp_grad_step for
+ * each curve, for the three step rules */
+static double check_mlogit(void){
+	int TT = 101, m = 4, N = 6, max_itr = 200, display = 0, nthreads = 3;
+	int i, j, k, step;
+	double tol = 1e-10, delta = 0.01, err = 0;
+	double *ti = malloc(sizeof(double)*(TT + m + TT*m + 4*TT*N));
+	double *alpha = ti + TT, *beta = alpha + m, *gami = beta + TT*m;
+	double *q = gami + TT*N, *gam1 = q + TT*N, *gam2 = gam1 + TT*N;
+	int *y = calloc(m*N, sizeof(int));
+
+	for (k=0; k<TT; k++)
+		ti[k] = (double)k / (TT-1);
+	for (j=0; j<m; j++){
+		alpha[j] = 0.1 * j;
+		for (k=0; k<TT; k++)
+			beta[j*TT+k] = sin((j+1)*3*ti[k]) / 3;
+	}
+	for (i=0; i<N; i++){
+		check_gamma(TT, 0, gami+i*TT);
+		for (k=0; k<TT; k++)
+			q[i*TT+k] = cos((i+1)*2*ti[k]) / 2 + 0.3;
+		y[i*m+i%m] = 1;
+	}
+
+	for (step=WARP_STEP_FIXED; step<=WARP_STEP_BB; step++){
+		mlogit_warp_grad_batch(&TT, &m, &N, alpha, beta, ti, gami, q, y, &max_itr, &tol, &delta, &display, &step, &nthreads, gam1);
+		for (i=0; i<N; i++)
+			mlogit_warp_grad_step(&TT, &m, alpha, beta, ti, gami+i*TT, q+i*TT, y+i*m, &max_itr, &tol, &delta, &display, &step, gam2+i*TT);
+		err = fmax(err, check_maxdiff(TT*N, gam1, gam2));
+	}
+
+	free(y);
+	free(ti);
+	return err;
+}
+
+/* The ocmlogit cost sum_j y_j (alpha_j + <nu_j, O q o gam>) - log sum_j exp(alpha_j + <nu_j, O q o gam>) */
+static double check_ocmcost(int n, int TT, int m, double *q, double *nu, double *alpha, int *y, double *gam, double *O){
+	int j, k;
+	double *qo = malloc(sizeof(double)*2*n*TT);
+	double *qt = qo + n*TT;
+	double A, s = 0, f = 0;
+
+	product(n, n, TT, O, q, qo);
+	group_action_by_gamma(&n, &TT, qo, gam, qt);
+	for (j=0; j<m; j++){
+		A = 0;
+		for (k=0; k<n*TT; k++)
+			A += qt[k] * nu[j*n*TT+k];
+		A /= TT;
+		s += exp(alpha[j] + A);
+		f += y[j] * (alpha[j] + A);
+	}
+
+	free(qo);
+	return f - log(s);
+}
+
+/* ocmlogit_warp_grad_batch on several threads against the same solver for
+ * each curve alone, in R^2 and R^3 for the three step rules. The decrease of
+ * the cost from the identity warping and rotation is written to errcost. */
+static double check_ocmlogit(double *errcost){
+	int TT = 60, m = 3, N = 8, max_itr = 200, display = 0, nthreads = 4, one = 1;
+	int i, k, n, step;
+	double tol = 1e-4, deltaO = 0.1, deltag = 0.05, err = 0;
+	double alpha[3] = {0.1, -0.2, 0.05}, I[9];
+	double *nu = malloc(sizeof(double)*(3*m*TT + 3*N*TT + 3*TT*N + 27*N));
+	double *q = nu + 3*m*TT, *gam1 = q + 3*N*TT, *gam2 = gam1 + TT*N, *O1 = gam2 + TT*N, *O2 = O1 + 9*N, *ti = O2 + 9*N;
+	int *y = calloc(m*N, sizeof(int));
+
+	*errcost = 0;
+	check_gamma(TT, 0, ti);
+	for (i=0; i<N; i++)
+		y[i*m+i%m] = 1;
+	for (n=2; n<=3; n++){
+		for (k=0; k<m*n*TT; k++)
+			nu[k] = sin(0.1*k*(1+k%3)) + 0.3*cos(0.05*k);
+		for (k=0; k<N*n*TT; k++)
+			q[k] = sin(0.07*k + k/(n*TT)) + 0.2*check_rand();
+		for (k=0; k<n*n; k++)
+			I[k] = (k % (n+1) == 0);
+
+		for (step=WARP_STEP_FIXED; step<=WARP_STEP_BB; step++){
+			ocmlogit_warp_grad_batch(&n, &TT, &m, &N, alpha, nu, q, y, &max_itr, &tol, &deltaO, &deltag, &display, &step, &nthreads, gam1, O1);
+			for (i=0; i<N; i++){
+				ocmlogit_warp_grad_batch(&n, &TT, &m, &one, alpha, nu, q+i*n*TT, y+i*m, &max_itr, &tol, &deltaO, &deltag, &display, &step, &one, gam2+i*TT, O2+i*n*n);
+				*errcost = fmax(*errcost, check_ocmcost(n, TT, m, q+i*n*TT, nu, alpha, y+i*m, ti, I)
+					- check_ocmcost(n, TT, m, q+i*n*TT, nu, alpha, y+i*m, gam1+i*TT, O1+i*n*n));
+			}
+			err = fmax(err, check_maxdiff(TT*N, gam1, gam2));
+			err = fmax(err, check_maxdiff(n*n*N, O1, O2));
+		}
+	}
+
+	free(y);
+	free(nu);
+	return err;
+}
+
+/* fpls_warp_grad_step on one thread and on four, for the three step rules */
+static double check_fpls(void){
+	int TT = 101, N = 12, max_itr = 100, display = 0;
+	int i, k, step;
+	double tol = 1e-8, delta = 0.01, err = 0;
+	double *ti = malloc(sizeof(double)*(3*TT + 5*TT*N));
+	double *wf = ti + TT, *wg = wf + TT, *gami = wg + TT;
+	double *qf = gami + TT*N, *qg = qf + TT*N, *gam1 = qg + TT*N, *gam2 = gam1 + TT*N;
+
+	check_gamma(TT, 0, ti);
+	for (k=0; k<TT; k++){
+		wf[k] = sin(2*M_PI*ti[k]);
+		wg[k] = cos(3*M_PI*ti[k]);
+	}
+	for (i=0; i<N; i++){
+		check_gamma(TT, 0, gami+i*TT);
+		for (k=0; k<TT; k++){
+			qf[i*TT+k] = sin((1 + 0.1*i)*2*M_PI*ti[k]);
+			qg[i*TT+k] = cos((1 + 0.05*i)*2*M_PI*ti[k]) + 0.1*i;
+		}
+	}
+
+	for (step=WARP_STEP_FIXED; step<=WARP_STEP_BB; step++){
+#ifdef _OPENMP
+		omp_set_num_threads(1);
+#endif
+		fpls_warp_grad_step(&TT, &N, ti, gami, qf, qg, wf, wg, &max_itr, &tol, &delta, &display, &step, gam1);
+#ifdef _OPENMP
+		omp_set_num_threads(4);
+#endif
+		fpls_warp_grad_step(&TT, &N, ti, gami, qf, qg, wf, wg, &max_itr, &tol, &delta, &display, &step, gam2);
+		err = fmax(err, check_maxdiff(TT*N, gam1, gam2));
+	}
+
+	free(ti);
+	return err;
+}
+
+int main(void){
+	int failed = 0;
+	double errapprox, errspline, errcost;
+
+	srand(1);
+	check_sorted(&errapprox, &errspline);
+	failed += check_report("approx", errapprox, 0);
+	failed += check_report("spline", errspline, 1e-13);
+	failed += check_report("invert", check_invert(101), 1e-3);
+	failed += check_report("mlogit", check_mlogit(), 0);
+	failed += check_report("ocmlogit", check_ocmlogit(&errcost), 0);
+	failed += check_report("ocmcost", errcost, 0);
+	failed += check_report("fpls", check_fpls(), 0);
+	printf("%d of 7 checks failed\n", failed);
+
+	return failed;
+}
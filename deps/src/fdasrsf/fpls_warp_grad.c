@@ -4,35 +4,132 @@
 #include <stdlib.h>
 #include "misc_funcs.h"
 
-void fpls_warp_grad(int *m1, int *n1, double *ti, double *gami, double *qf, double *qg, double *wf, double *wg,
-	int *max_itri, double *toli, double *deltai, int *displayi, double *gamout){
+/* Cost cov(rfi, rgi) at the warps gam (TT x N) and the gradient grad (TT x N)
+ * with respect to each psi_k. The functions are independent given the sums of
+ * rfi and rgi, so both passes over k run on OpenMP threads with scratch local
+ * to the loop body; the sums are reduced serially in a fixed order so the
+ * result does not depend on the thread count. dg is TT x N workspace. */
+static double fpls_eval(int TT, int N, double *ti, double *qf, double *qg, double *wf, double *wg, double binsize, double *psi, double *gam, double *grad, double *dg){
 
+	// Looping and temp variables
+	int k, j;
+	double N1 = N;
+	double rfi[N], rgi[N];
+	double sumf, sumg, out;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(j) schedule(static)
+#endif
+	for (k=0; k<N; k++) {
+		int n2 = 1;
+		double tmp[TT], tmp1[TT], xout[TT], qf_tmp[TT], qg_tmp[TT], qf_tmp_diff[TT], qg_tmp_diff[TT];
+		double tmpi;
+		double *psi_ptr = psi+k*TT, *rfi_diff = grad+k*TT, *rgi_diff = dg+k*TT;
+
+		for (j=0; j<TT; j++)
+			xout[j] = (ti[TT-1] - ti[0])*gam[k*TT+j]+ti[0];
+		spline_sorted(TT, ti, qf+k*TT, TT, xout, qf_tmp);
+		spline_sorted(TT, ti, qg+k*TT, TT, xout, qg_tmp);
+
+		for (j=0; j<TT; j++)
+			tmp[j] = qf_tmp[j]*psi_ptr[j];
+		innerprod_q(&TT, ti, tmp, wf, &tmpi); rfi[k] = tmpi;
+		for (j=0; j<TT; j++)
+			tmp[j] = qg_tmp[j]*psi_ptr[j];
+		innerprod_q(&TT, ti, tmp, wg, &tmpi); rgi[k] = tmpi;
+
+		gradient(&TT,&n2,qf+k*TT,&binsize,tmp);
+		spline_sorted(TT, ti, tmp, TT, xout, qf_tmp_diff);
+		gradient(&TT,&n2,qg+k*TT,&binsize,tmp);
+		spline_sorted(TT, ti, tmp, TT, xout, qg_tmp_diff);
+
+		for (j=0; j<TT; j++)
+			tmp[j] = qf_tmp_diff[j]*psi_ptr[j]*wf[j];
+		trapz(&TT, &n2, ti, tmp, &tmpi);
+		cumtrapz(&TT, ti, tmp, tmp1);
+		for (j=0; j<TT; j++)
+			tmp1[j] = tmpi - tmp1[j];
+		for (j=0; j<TT; j++)
+			rfi_diff[j] = 2*psi_ptr[j]*tmp1[j]+qf_tmp[j]*wf[j];
+
+		for (j=0; j<TT; j++)
+			tmp[j] = qg_tmp_diff[j]*psi_ptr[j]*wg[j];
+		trapz(&TT, &n2, ti, tmp, &tmpi);
+		cumtrapz(&TT, ti, tmp, tmp1);
+		for (j=0; j<TT; j++)
+			tmp1[j] = tmpi - tmp1[j];
+		for (j=0; j<TT; j++)
+			rgi_diff[j] = 2*psi_ptr[j]*tmp1[j]+qg_tmp[j]*wg[j];
+	}
 
-	// dereference inputs
-	int TT = *m1;
-	int N = *n1, max_itr = *max_itri;
-	double t = *ti, gam = *gami;
-	double tol = *toli, delta = *deltai, display = *displayi;
+	sumf = 0;
+	sumg = 0;
+	for (k=0; k<N; k++){
+		sumf += rfi[k];
+		sumg += rgi[k];
+	}
 
-	// Looping and temp variables
+#ifdef _OPENMP
+#pragma omp parallel for private(j) schedule(static)
+#endif
+	for (k=0; k<N; k++) {
+		double *grad_ptr = grad+k*TT, *rgi_diff = dg+k*TT;
+		double rfi_diff, tmpi, tmpj;
+
+		// sums over j != k
+		tmpi = sumf - rfi[k];
+		tmpj = sumg - rgi[k];
+		for (j=0; j<TT; j++){
+			rfi_diff = grad_ptr[j];
+			grad_ptr[j] = 1/N1*rfi_diff*rgi[k]+1/N1*rfi[k]*rgi_diff[j] - 1/(N1*N1)*rfi_diff*rgi[k]-1/(N1*N1)*rfi[k]*rgi_diff[j] - 1/(N1*N1)*rfi_diff*tmpj- 1/(N1*N1)*rgi_diff[j]*tmpi;
+		}
+	}
+
+	cov(N, rfi, rgi, &out);
+
+	return out;
+}
+
+/* Move every psi_k along its geodesic by step, then rescale as the original
+ * solver does and recompute the warps. */
+static void fpls_step(int TT, int N, double *ti, double *psi, double *vec, double *vn, double step, double *psi2, double *gam2){
 	int k, j;
-	int n2 = 1;
+	double tmpi;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(j, tmpi) schedule(static)
+#endif
+	for (k=0; k<N; k++){
+		sphere_exp(TT, psi+k*TT, vec+k*TT, vn[k], step, psi2+k*TT);
+
+		innerprod_q(&TT, ti, psi2+k*TT, psi2+k*TT, &tmpi);
+		for (j=0; j<TT; j++)
+			psi2[k*TT+j] = psi2[k*TT+j]/tmpi;
+
+		psi_to_gam(TT, ti, psi2+k*TT, gam2+k*TT);
+	}
+}
+
+static void fpls_warp_grad1(int TT, int N, double *ti, double *gami, double *qf, double *qg, double *wf, double *wg,
+	int max_itr, double tol, double delta, int display, int step, double *gamout){
+
+	// Looping and temp variables
+	int k, j, ls;
 	int itr = 1;
-	double tmp2 = 0;
-	double N1 = N;
-	double psi1[TT*N], gam2[TT*N], rfi_diff[TT], rgi_diff[TT], grad[TT], vec[TT], gamI[TT];
+	int fresh = 1;
+	double vn[N];
 	double eps = DBL_EPSILON;
-	double tmp[TT], psi2[TT*N], xout[TT], qf_tmp[TT*N], qg_tmp[TT*N];
-	double binsize, rfi[N], rgi[N], qf_tmp_diff[TT*N], qg_tmp_diff[TT*N];
-	double max_val[max_itr], tmpi, tmpj, gam1[TT*N];
-	double res_cos, res_sin, max_val_change;
-	double *tmp1 = malloc(sizeof(double)*(TT));
+	double binsize, max_val[max_itr], tmpi, slope, st = delta, fc, f2;
+	double max_val_change;
 
 	// Pointers
-	double *qf_ptr, *qg_ptr, *gam_ptr, *psi_ptr, *gam2_ptr, *psi2_ptr;
-	double *qf_tmp_ptr, *qg_tmp_ptr, *qf_tmp_diff_ptr, *qg_tmp_diff_ptr;
-	double *xout_ptr, *tmp_ptr, *tmp1_ptr, *tmpi_ptr, *tmpj_ptr;
-	double *grad_ptr, *rfi_ptr, *rgi_ptr, *gamI_ptr;
+	double *gam_ptr, *psi_ptr, *grad_ptr, *gam2_ptr, *psi2_ptr, *grad2_ptr, *swap_ptr;
+
+	// TT x N blocks are too large for the stack with many functions
+	double *work = malloc(sizeof(double)*(9*TT*N));
+	double *psi1 = work, *gam1 = psi1 + TT*N, *psi2 = gam1 + TT*N, *gam2 = psi2 + TT*N;
+	double *grad1 = gam2 + TT*N, *grad2 = grad1 + TT*N, *vec = grad2 + TT*N, *vprev = vec + TT*N;
+	double *dg = vprev + TT*N;
 
 	binsize = 0;
 	for (k=0; k<TT-1; k++)
@@ -42,159 +139,77 @@ void fpls_warp_grad(int *m1, int *n1, double *ti, double *gami, double *qf, doub
 	for (k=0; k<TT*N; k++){
 		gam1[k] = gami[k];
 	}
-	psi_ptr = psi1; gam_ptr = gam1;
-	gradient(m1,n1,gam_ptr,&binsize,psi_ptr);
+	psi_ptr = psi1; gam_ptr = gam1; grad_ptr = grad1;
+	psi2_ptr = psi2; gam2_ptr = gam2; grad2_ptr = grad2;
+	gradient(&TT,&N,gam_ptr,&binsize,psi_ptr);
 	for (k=0; k<TT*N; k++)
 		psi1[k] = sqrt(fabs(psi1[k])+eps);
 
-	do {
-		qf_ptr = qf; qf_tmp_ptr = qf_tmp;
-		qg_ptr = qg; qg_tmp_ptr = qg_tmp;
-		qf_tmp_diff_ptr = qf_tmp_diff; qg_tmp_diff_ptr = qg_tmp_diff;
-		for (k=0; k<N; k++) {
-			for (j=0; j<TT; j++)
-				xout[j] = (ti[TT-1] - ti[0])*gam_ptr[j]+ti[0];
-			xout_ptr = xout;
-			spline(TT, ti, qf_ptr, TT, xout_ptr, qf_tmp_ptr);
-			spline(TT, ti, qg_ptr, TT, xout_ptr, qg_tmp_ptr);
+	fc = fpls_eval(TT, N, ti, qf, qg, wf, wg, binsize, psi_ptr, gam_ptr, grad_ptr, dg);
 
+	do {
+		if (!fresh)
+			fc = fpls_eval(TT, N, ti, qf, qg, wf, wg, binsize, psi_ptr, gam_ptr, grad_ptr, dg);
+		fresh = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(j, tmpi) schedule(static)
+#endif
+		for (k=0; k<N; k++){
+			innerprod_q(&TT, ti, grad_ptr+k*TT, psi_ptr+k*TT, &tmpi);
 			for (j=0; j<TT; j++)
-				tmp[j] = qf_tmp_ptr[j]*psi_ptr[j];
-			tmp_ptr = tmp;
-			innerprod_q(m1, ti, tmp_ptr, wf, &tmpi); rfi[k] = tmpi;
-			for (j=0; j<TT; j++)
-				tmp[j] = qg_tmp_ptr[j]*psi_ptr[j];
-			tmp_ptr = tmp;
-			innerprod_q(m1, ti, tmp_ptr, wg, &tmpi); rgi[k] = tmpi;
-
-			tmp_ptr = tmp;
-			gradient(m1,&n2,qf_ptr,&binsize,tmp_ptr);
-			spline(TT, ti, tmp_ptr, TT, xout_ptr, qf_tmp_diff_ptr);
-			tmp_ptr = tmp;
-			gradient(m1,&n2,qg_ptr,&binsize,tmp_ptr);
-			spline(TT, ti, tmp_ptr, TT, xout_ptr, qg_tmp_diff_ptr);
-
-			qf_ptr += TT;
-			qf_tmp_ptr += TT;
-			qg_ptr += TT;
-			qg_tmp_ptr += TT;
-			gam_ptr += TT;
-			psi_ptr += TT;
-			qf_tmp_diff_ptr += TT;
-			qg_tmp_diff_ptr += TT;
+				vec[k*TT+j] = grad_ptr[k*TT+j] - tmpi*psi_ptr[k*TT+j];
+			pvecnorm2(&TT, vec+k*TT, &binsize, &vn[k]);
 		}
 
-		psi_ptr = psi_ptr - TT*N;
-		qf_tmp_diff_ptr = qf_tmp_diff; qg_tmp_diff_ptr = qg_tmp_diff;
-		qg_tmp_ptr = qg_tmp; qf_tmp_ptr = qf_tmp;
-		psi2_ptr = psi2; gam2_ptr = gam2;
-		for (k=0; k<N; k++) {
-			tmp_ptr = tmp;
-			for (j=0; j<TT; j++)
-				tmp_ptr[j] = qf_tmp_diff_ptr[j]*psi_ptr[j]*wf[j];
-			tmp1_ptr = tmp1;
-			tmpi_ptr = &tmpi;
-			trapz(&TT, &n2, ti, tmp_ptr, tmpi_ptr);
-			cumtrapz(&TT, ti, tmp_ptr, tmp1_ptr);
-			for (j=0; j<TT; j++)
-				tmp1[j] = tmpi - tmp1[j];
-			for (j=0; j<TT; j++)
-				rfi_diff[j] = 2*psi_ptr[j]*tmp1[j]+qf_tmp_ptr[j]*wf[j];
+		max_val[itr] = fc;
 
-			tmp_ptr = tmp;
-			for (j=0; j<TT; j++)
-				tmp_ptr[j] = qg_tmp_diff_ptr[j]*psi_ptr[j]*wg[j];
-			tmp1_ptr = tmp1;
-			tmpi_ptr = &tmpi;
-			trapz(&TT, &n2, ti, tmp_ptr, tmpi_ptr);
-			cumtrapz(&TT, ti, tmp_ptr, tmp1_ptr);
-			for (j=0; j<TT; j++)
-				tmp1[j] = tmpi - tmp1[j];
-			for (j=0; j<TT; j++)
-				rgi_diff[j] = 2*psi_ptr[j]*tmp1[j]+qg_tmp_ptr[j]*wg[j];
-
-			tmpi = 0;
-			tmpj = 0;
-			for (j=0; j<N; j++){
-				if (j == k)
-					continue;
-
-				tmpi += rfi[j];
-				tmpj += rgi[j];
-			}
-			for (j=0; j<TT; j++)
-				grad[j] = 1/N1*rfi_diff[j]*rgi[k]+1/N1*rfi[k]*rgi_diff[j] - 1/(N1*N1)*rfi_diff[j]*rgi[k]-1/(N1*N1)*rfi[k]*rgi_diff[j] - 1/(N1*N1)*rfi_diff[j]*tmpj- 1/(N1*N1)*rgi_diff[j]*tmpi;
-
-			grad_ptr = grad;
-			tmpi_ptr = &tmpi;
-			innerprod_q(m1, ti, grad_ptr, psi_ptr, tmpi_ptr);
-			for (j=0; j<TT; j++)
-				vec[j] = grad[j] - tmpi*psi_ptr[j];
-
-			pvecnorm2(&TT, vec, &binsize, &tmpi);
-			res_cos = cos(delta*tmpi);
-			res_sin = sin(delta*tmpi);
-			for (j=0; j<TT; j++)
-				psi2_ptr[j] = res_cos*psi_ptr[j] + res_sin*(vec[j]/tmpi);
-
-			innerprod_q(m1, ti, psi2_ptr, psi2_ptr, &tmpi);
-			for (j=0; j<TT; j++)
-				psi2_ptr[j] = psi2_ptr[j]/tmpi;
-
-			for (j=0; j<TT; j++)
-				tmp1[j] = psi2_ptr[j]*psi2_ptr[j];
+		if (display == 1)
+			printf("Iteration %d : Cost %f\n", itr, max_val[itr]);
 
-			tmp1_ptr = tmp1;
-			cumtrapz(&TT,ti,tmp1_ptr,gam2_ptr);
-			for (j=0; j<TT; j++)
-				gam2_ptr[j] = (gam2_ptr[j] - gam2_ptr[0])/(gam2_ptr[TT-1]-gam2_ptr[0]); // slight change of scale
+		if (step == WARP_STEP_FIXED){
+			fpls_step(TT, N, ti, psi_ptr, vec, vn, delta, psi2_ptr, gam2_ptr);
 
-			qf_tmp_diff_ptr += TT;
-			qg_tmp_diff_ptr += TT;
-			psi_ptr += TT;
-			qf_tmp_ptr += TT;
-			qg_tmp_ptr += TT;
-			psi2_ptr += TT;
-			gam2_ptr += TT;
+			swap_ptr = psi_ptr; psi_ptr = psi2_ptr; psi2_ptr = swap_ptr;
+			swap_ptr = gam_ptr; gam_ptr = gam2_ptr; gam2_ptr = swap_ptr;
 
+			if (itr >= 2){
+				max_val_change = max_val[itr] - max_val[itr-1];
+				if (fabs(max_val_change) < tol)
+					break;
+				if (max_val_change < 0)
+					break;
+			}
 		}
+		else{
+			slope = 0;
+			for (j=0; j<TT*N; j++)
+				slope += vec[j]*vec[j];
+			slope *= binsize;
+			if (slope == 0)
+				break;
 
-		rfi_ptr = rfi;
-		rgi_ptr = rgi;
-		tmpi_ptr = &tmpi;
-		cov(N, rfi_ptr, rgi_ptr, tmpi_ptr);
-		max_val[itr] = tmpi;
+			st = warp_step_init(step, itr, delta, st, TT*N, binsize, vec, vprev);
+			for (ls=0; ls<WARP_MAX_BACKTRACK; ls++){
+				fpls_step(TT, N, ti, psi_ptr, vec, vn, st, psi2_ptr, gam2_ptr);
+				f2 = fpls_eval(TT, N, ti, qf, qg, wf, wg, binsize, psi2_ptr, gam2_ptr, grad2_ptr, dg);
+				if (f2 >= fc + WARP_ARMIJO_C1*st*slope)
+					break;
+				st *= 0.5;
+			}
+			if (ls == WARP_MAX_BACKTRACK)
+				break;
 
-		if (display == 1)
-			printf("Iteration %d : Cost %f\n", itr, max_val[itr]);
+			for (j=0; j<TT*N; j++)
+				vprev[j] = vec[j];
+			swap_ptr = psi_ptr; psi_ptr = psi2_ptr; psi2_ptr = swap_ptr;
+			swap_ptr = gam_ptr; gam_ptr = gam2_ptr; gam2_ptr = swap_ptr;
+			swap_ptr = grad_ptr; grad_ptr = grad2_ptr; grad2_ptr = swap_ptr;
+			max_val_change = f2 - fc;
+			fc = f2;
+			fresh = 1;
 
-		gam_ptr = gam2;
-		// gamI_ptr = gamI;
-		// SqrtMeanInverse(m1, n1, ti, gam_ptr, gamI_ptr);
-
-		// gam2_ptr = gam1;
-		// for (k=0; k<N; k++) {
-		// 	for (j=0; j<TT; j++)
-		// 		xout[j] = (ti[TT-1] - ti[0])*gamI_ptr[j]+ti[0];
-		// 	xout_ptr = xout;
-		// 	approx(ti, gam_ptr, TT, xout_ptr, gam2_ptr, TT, 1, 0, 1, 0);
-
-		// 	gam_ptr += TT;
-		// 	gam2_ptr += TT;
-		// }
-
-		// gam_ptr = gam1;
-		// psi_ptr = psi2;
-		// gradient(m1,n1,gam_ptr,&binsize,psi_ptr);
-		// for (k=0; k<TT*N; k++)
-		// 	psi2[k] = sqrt(fabs(psi2[k])+eps);
-		psi_ptr = psi2;
-
-		if (itr >= 2){
-			max_val_change = max_val[itr] - max_val[itr-1];
-			if (fabs(max_val_change) < tol)
-				break;
-			if (max_val_change < 0)
+			if (max_val_change < tol)
 				break;
 		}
 
@@ -206,5 +221,19 @@ void fpls_warp_grad(int *m1, int *n1, double *ti, double *gami, double *qf, doub
 		gamout[k] = gam_ptr[k];
 	}
 
-	free(tmp1);
+	free(work);
+}
+
+void fpls_warp_grad(int *m1, int *n1, double *ti, double *gami, double *qf, double *qg, double *wf, double *wg,
+	int *max_itri, double *toli, double *deltai, int *displayi, double *gamout){
+
+	// dereference inputs
+	fpls_warp_grad1(*m1, *n1, ti, gami, qf, qg, wf, wg, *max_itri, *toli, *deltai, *displayi, WARP_STEP_FIXED, gamout);
+}
+
+void fpls_warp_grad_step(int *m1, int *n1, double *ti, double *gami, double *qf, double *qg, double *wf, double *wg,
+	int *max_itri, double *toli, double *deltai, int *displayi, int *stepi, double *gamout){
+
+	// dereference inputs
+	fpls_warp_grad1(*m1, *n1, ti, gami, qf, qg, wf, wg, *max_itri, *toli, *deltai, *displayi, *stepi, gamout);
 }
@@ -1,2 +1,6 @@
 void fpls_warp_grad(int *m1, int *n1, double *ti, double *gami, double *qf, double *qg, double *wf, double *wg, 
-	int *max_itri, double *toli, double *deltai, int *displayi, double *gamout);
\ No newline at end of file
+	int *max_itri, double *toli, double *deltai, int *displayi, double *gamout);
+
+/* Same with a step rule (WARP_STEP_FIXED, WARP_STEP_ARMIJO or WARP_STEP_BB) */
+void fpls_warp_grad_step(int *m1, int *n1, double *ti, double *gami, double *qf, double *qg, double *wf, double *wg,
+	int *max_itri, double *toli, double *deltai, int *displayi, int *stepi, double *gamout);
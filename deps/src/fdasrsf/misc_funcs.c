@@ -2,6 +2,7 @@
 #include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "misc_funcs.h"
 
 /* Structure of Linear Interpolation */
 typedef struct {
@@ -376,6 +377,46 @@ void spline_eval(int nu, double *u, double *v, int n, double *x, double *y, doub
 }
 
 
+void spline_eval_sorted(int nu, double *u, double *v, int n, double *x, double *y, double *b, double *c, double *d)
+{
+    /* Same as spline_eval (fmm) for nondecreasing u: the interval is found by
+    * advancing a single cursor, so the whole call is O(nu + n). Out of order
+    * queries fall back to bisection, so the result is always correct.
+    */
+
+    const int n_1 = n - 1;
+    int i, j, k, l;
+    int *idx = malloc(sizeof(int)*(nu));
+    double ul, dx;
+
+    /* locate intervals */
+    for(l = 0, i = 0; l < nu; l++) {
+    ul = u[l];
+    if(ul < x[i] && i > 0) {
+        i = 0;
+        j = n;
+        do {
+        k = (i+j)/2;
+        if(ul < x[k]) j = k;
+        else i = k;
+        } while(j > i+1);
+    }
+    while(i < n_1 && x[i+1] < ul)
+        i++;
+    idx[l] = i;
+    }
+
+    /* Horner evaluation, free of branches so it vectorises */
+    for(l = 0; l < nu; l++) {
+    i = idx[l];
+    dx = u[l] - x[i];
+    v[l] = y[i] + dx*(b[i] + dx*(c[i] + dx*d[i]));
+    }
+
+    free(idx);
+}
+
+
 void spline(int n, double *x, double *y, int nu, double *xi, double *yi) {
     double *b = malloc(sizeof(double)*(n));
     double *c = malloc(sizeof(double)*(n));
@@ -389,6 +430,19 @@ void spline(int n, double *x, double *y, int nu, double *xi, double *yi) {
 }
 
 
+void spline_sorted(int n, double *x, double *y, int nu, double *xi, double *yi) {
+    double *b = malloc(sizeof(double)*(n));
+    double *c = malloc(sizeof(double)*(n));
+    double *d = malloc(sizeof(double)*(n));
+
+    spline_coef(n, x, y, b, c, d);
+    spline_eval_sorted(nu, xi, yi, n, x, y, b, c, d);
+
+    free(b); free(c); free(d);
+    return;
+}
+
+
 static double approx1(double v, double *x, double *y, int n, appr_meth *Meth) {
   /* Approximate  y(v),  given (x,y)[i], i = 0,..,n-1 */
   int i, j, ij;
@@ -438,21 +492,45 @@ void approx(double *x, double *y, int nxy, double *xout, double *yout,
 		return;
 }
 
+void approx_sorted(double *x, double *y, int nxy, double *xout, double *yout,
+	    int nout, int method, double yleft, double yright, double f)
+{
+    /* Same as approx for nondecreasing xout: a single cursor walks the table
+     * instead of bisecting for every point. Out of order points restart the
+     * cursor from the left, so the result is always correct. */
+    int i, l;
+    double v;
+
+    for(l = 0, i = 0; l < nout; l++) {
+		v = xout[l];
+		if(v < x[0]) { yout[l] = yleft; continue; }
+		if(v > x[nxy-1]) { yout[l] = yright; continue; }
+		if(v < x[i]) i = 0;
+		while(i < nxy - 2 && v >= x[i+1])
+			i++;
+
+		if(v == x[i+1]) yout[l] = y[i+1];
+		else if(v == x[i]) yout[l] = y[i];
+		else if(method == 1) /* linear */
+			yout[l] = y[i] + (y[i+1] - y[i]) * ((v - x[i])/(x[i+1] - x[i]));
+		else /* 2 : constant */
+			yout[l] = y[i] * (1 - f) + y[i+1] * f;
+    }
+
+    return;
+}
+
 void invertGamma(int n, double *gam, double *out) {
 	double *x = malloc(sizeof(double)*(n));
-	double *y = malloc(sizeof(double)*(n));
 	int k;
 
 	for (k=0; k<n; k++)
 		x[k] = (double)k/((double)(n-1));
 
-	approx(gam, x, n, x, out, n, 1, 0, 1, 0);
-	out[n] = 1;
-
-	for (k=0; k<n; k++)
-		out[k] = out[k]/out[n];
+	/* x is sorted, so the inverse can be read off with a single sweep */
+	approx_sorted(gam, x, n, x, out, n, 1, 0, 1, 0);
 
-	free(x); free(y);
+	free(x);
 	return;
 }
 
@@ -618,6 +696,72 @@ void linspace(double min, double max, int n, double *result){
 }
 
 
+/* Exp-map step on the psi sphere */
+void sphere_exp(int n, double *psi, double *v, double vnorm, double step, double *psi2){
+    double res_cos, res_sin;
+    int k;
+
+    res_cos = cos(step*vnorm);
+    res_sin = sin(step*vnorm);
+    if (vnorm == 0){
+        for (k=0; k<n; k++)
+            psi2[k] = res_cos*psi[k];
+    }
+    else{
+        for (k=0; k<n; k++)
+            psi2[k] = res_cos*psi[k] + res_sin*(v[k]/vnorm);
+    }
+
+    return;
+}
+
+
+/* warping function from psi */
+void psi_to_gam(int n, double *ti, double *psi, double *gam){
+    double tmp[n];
+    int k;
+
+    for (k=0; k<n; k++)
+        tmp[k] = psi[k]*psi[k];
+
+    cumtrapz(&n, ti, tmp, gam);
+    for (k=0; k<n; k++)
+        gam[k] = (gam[k] - gam[0])/(gam[n-1]-gam[0]); // slight change of scale
+
+    return;
+}
+
+
+/* initial trial step for the adaptive step rules */
+double warp_step_init(int rule, int itr, double delta, double tprev, int n, double dt, double *v, double *vprev){
+    double ss = 0, sy = 0, step;
+    int k;
+
+    if (rule == WARP_STEP_FIXED || itr <= 1)
+        return delta;
+
+    step = 2*tprev;
+    if (rule == WARP_STEP_BB){
+        /* s = tprev*vprev, y = v - vprev; ascent so <s,y> < 0 near a maximum */
+        for (k=0; k<n; k++){
+            ss += vprev[k]*vprev[k];
+            sy += vprev[k]*(v[k]-vprev[k]);
+        }
+        ss *= tprev*tprev*dt;
+        sy *= tprev*dt;
+        if (sy < 0)
+            step = ss/(-sy);
+    }
+
+    if (step < 1e-3*delta)
+        step = 1e-3*delta;
+    if (step > 1e3*delta)
+        step = 1e3*delta;
+
+    return step;
+}
+
+
 /* reparameterize srvf q by gamma */
 void group_action_by_gamma(int *n1, int *T1, double *q, double *gam, double *qn){
     int T = *T1, n = *n1;
@@ -638,13 +782,17 @@ void group_action_by_gamma(int *n1, int *T1, double *q, double *gam, double *qn)
 		tmp1_ptr = tmp1;
         for (j=0; j<T; j++)
             tmp[j] = q[n*j+k];
-        spline(T, time_ptr, tmp_ptr, T, gam, tmp1_ptr);
+        spline_sorted(T, time_ptr, tmp_ptr, T, gam, tmp1_ptr);
         for (j=0; j<T; j++)
             qn[n*j+k] = tmp1[j]* sqrt(gammadot[j]);
 
     }
 
-    val = innerprod_q2(T1, qn, qn);
+    // innerprod_q2 assumes curves in R^2
+    val = 0;
+    for (k=0; k<T*n; k++)
+        val += qn[k]*qn[k];
+    val = val/T;
 
     for (k=0; k<T*n; k++)
         qn[k] = qn[k] / sqrt(val);
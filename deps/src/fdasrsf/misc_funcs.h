@@ -37,9 +37,16 @@ void spline(int n, double *x, double *y, int nu, double *xi, double *yi);
 void spline_coef(int n, double *x, double *y, double *b, double *c, double *d);
 void spline_eval(int nu, double *u, double *v, int n, double *x, double *y, double *b, double *c, double *d);
 
+/* Spline Interpolation at nondecreasing points (single cursor, O(n + nu)) */
+void spline_sorted(int n, double *x, double *y, int nu, double *xi, double *yi);
+void spline_eval_sorted(int nu, double *u, double *v, int n, double *x, double *y, double *b, double *c, double *d);
+
 /* Linear Interpoloation */
 void approx(double *x, double *y, int nxy, double *xout, double *yout, int nout, int method, double yleft, double yright, double f);
 
+/* Linear Interpoloation at nondecreasing points (single cursor, O(nxy + nout)) */
+void approx_sorted(double *x, double *y, int nxy, double *xout, double *yout, int nout, int method, double yleft, double yright, double f);
+
 /* Invert Gamma */
 void invertGamma(int n, double *gam, double *out);
 
@@ -49,5 +56,21 @@ void SqrtMeanInverse(int *T1, int *n1, double *ti, double *gami, double *out);
 /* linear spaced vector */
 void linspace(double min, double max, int n, double *result);
 
+/* Step rules for the warp gradient solvers: fixed delta, Armijo backtracking, Barzilai-Borwein with Armijo safeguard */
+#define WARP_STEP_FIXED 0
+#define WARP_STEP_ARMIJO 1
+#define WARP_STEP_BB 2
+#define WARP_ARMIJO_C1 1e-4
+#define WARP_MAX_BACKTRACK 30
+
+/* Exp-map step psi2 = cos(step*vnorm)*psi + sin(step*vnorm)*v/vnorm on the psi sphere */
+void sphere_exp(int n, double *psi, double *v, double vnorm, double step, double *psi2);
+
+/* Warping function gam = cumtrapz(psi^2) rescaled to [0,1] */
+void psi_to_gam(int n, double *ti, double *psi, double *gam);
+
+/* Initial trial step of the Armijo/BB rules, v and vprev are the current and previous ascent directions */
+double warp_step_init(int rule, int itr, double delta, double tprev, int n, double dt, double *v, double *vprev);
+
 /* reparameterize srvf q by gamma */
 void group_action_by_gamma(int *n1, int *T1, double *q, double *gam, double *qn);
@@ -2,186 +2,238 @@
 #include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "misc_funcs.h"
 
-void mlogit_warp_grad(int *m1, int *m2, double *alpha, double *beta, double *ti, double *gami, double *q, int *y, int *max_itri, double *toli, double *deltai, int *displayi, double *gamout){
+/* Cost and (unprojected) gradient h at the warp gam with psi = sqrt(gam').
+ * The m class terms are written as matrix products with beta (TT x m, column
+ * major): A = beta' * (w .* q(gam) .* psi) with w the trapezoid weights, and
+ * since the gradient only needs sum_j c_j Adiff_j with c = y - softmax(alpha + A),
+ * it is built from b = beta * c with a single cumulative pass instead of one
+ * trapz/cumtrapz per class. work holds 6*TT doubles. */
+static double mlogit_eval(int TT, int m, double *alpha, double *beta, double *ti, double *w, double *q, double *dq, int *y, double *psi, double *gam, double *h, double *work){
 
+	int k, j;
+	double *q_tmp = work, *q_tmp_diff = q_tmp + TT, *xout = q_tmp_diff + TT;
+	double *u = xout + TT, *b = u + TT, *tmp = b + TT;
+	double A[m], c[m], tmp1, tmpi, r;
+	double *beta_ptr;
 
-	// dereference inputs
-	// alpha, beta, q should be normalized by norm
-	int TT = *m1;
-	int m = *m2;
-	int max_itr = *max_itri;
-	double t = *ti;
-	double tol = *toli, delta = *deltai, display = *displayi;
+	for (j=0; j<TT; j++)
+		xout[j] = (ti[TT-1] - ti[0])*gam[j]+ti[0];
+	spline_sorted(TT, ti, q, TT, xout, q_tmp);
+	spline_sorted(TT, ti, dq, TT, xout, q_tmp_diff);
+
+	// A = beta' * u (gemv)
+	for (k=0; k<TT; k++)
+		u[k] = w[k]*q_tmp[k]*psi[k];
+	beta_ptr = beta;
+	for (j=0; j<m; j++){
+		tmpi = 0;
+		for (k=0; k<TT; k++)
+			tmpi += beta_ptr[k]*u[k];
+		A[j] = tmpi;
+		beta_ptr += TT;
+	}
+
+	tmp1 = 0;
+	for (j=0; j<m; j++){
+		c[j] = exp(alpha[j] + A[j]);
+		tmp1 += c[j];
+	}
+	for (j=0; j<m; j++)
+		c[j] = y[j] - c[j]/tmp1;
+
+	// b = beta * c (gemv)
+	for (k=0; k<TT; k++)
+		b[k] = 0;
+	beta_ptr = beta;
+	for (j=0; j<m; j++){
+		for (k=0; k<TT; k++)
+			b[k] += c[j]*beta_ptr[k];
+		beta_ptr += TT;
+	}
+
+	// h = 2 psi int_t^1 (q' psi b) + q b, one reverse cumulative pass
+	for (k=0; k<TT; k++){
+		tmp[k] = q_tmp_diff[k]*psi[k]*b[k];
+		h[k] = q_tmp[k]*b[k];
+	}
+	r = 0;
+	for (k=TT-2; k>=0; k--){
+		r += 0.5*(tmp[k]+tmp[k+1])*(ti[k+1]-ti[k]);
+		h[k] += 2*psi[k]*r;
+	}
+
+	tmpi = 0;
+	for (j=0; j<m; j++)
+		tmpi += y[j] * (alpha[j] + A[j]);
+
+	return tmpi - log(tmp1);
+}
+
+/* Warp one observation by gradient ascent on the psi sphere. With step
+ * WARP_STEP_FIXED every iteration moves delta along the geodesic and stops at
+ * the first decrease; the adaptive rules backtrack from an initial trial step
+ * until the Armijo condition holds and stop when the gain drops below tol. */
+static void mlogit_warp_grad1(int TT, int m, double *alpha, double *beta, double *ti, double *gami, double *q, int *y, int max_itr, double tol, double delta, int display, int step, double *gamout){
 
 	// Looping and temp variables
-	int k, j;
+	int k, j, ls;
 	int n1 = 1;
 	int itr = 1;
-	double gam1[TT], psi1[TT], q_tmp[TT], q_tmp_diff[TT];
-	double A[m], Adiff[TT*m], xout[TT], tmp[TT], tmp1, tmpi, binsize;
+	int fresh = 1;
+	double *work = malloc(sizeof(double)*(16*TT + max_itr + 1));
+	double *gam1 = work, *psi1 = gam1 + TT, *dq = psi1 + TT, *w = dq + TT, *h1 = w + TT, *vec = h1 + TT, *vprev = vec + TT;
+	double *psi2 = vprev + TT, *gam2 = psi2 + TT, *h2 = gam2 + TT, *evalwork = h2 + TT, *max_val = evalwork + 6*TT;
 	double eps = DBL_EPSILON;
-	double tmp3[TT*m], h[TT], vec[TT];
-	double psi2[TT], gam2[TT];
-	double res_cos, res_sin, max_val_change, max_val[max_itr];
-	double *tmp2 = malloc(sizeof(double)*(TT));
+	double tmpi, binsize, rn, slope, st = delta, fc, f2;
+	double max_val_change;
 
 	// Pointers
-	double *psi_ptr, *gam_ptr, *q_ptr, *q_tmp_ptr, *q_tmp_diff_ptr;
-	double *xout_ptr, *tmp_ptr, *A_ptr, *Adiff_ptr, *tmp1_ptr, *tmp2_ptr;
-	double *alpha_ptr, *beta_ptr, *tmp3_ptr, *h_ptr;
-	int *y_ptr;
-	double *psi2_ptr, *gam2_ptr, *tmpi_ptr;
+	double *psi_ptr, *gam_ptr, *h_ptr, *psi2_ptr, *gam2_ptr, *h2_ptr, *swap_ptr;
 
 	binsize = 0;
 	for (k=0; k<TT-1; k++)
 		binsize += ti[k+1]-ti[k];
 	binsize = binsize/(TT-1);
 
+	// trapezoid weights
+	for (k=0; k<TT; k++)
+		w[k] = 0;
+	for (k=0; k<TT-1; k++){
+		w[k] += 0.5*(ti[k+1]-ti[k]);
+		w[k+1] += 0.5*(ti[k+1]-ti[k]);
+	}
+
+	// derivative of q does not depend on the warp
+	gradient(&TT,&n1,q,&binsize,dq);
+
 	for (k=0; k<TT; k++){
 		gam1[k] = gami[k];
 	}
-	psi_ptr = psi1; gam_ptr = gam1;
-	gradient(m1,&n1,gam_ptr,&binsize,psi_ptr);
+	psi_ptr = psi1; gam_ptr = gam1; h_ptr = h1;
+	psi2_ptr = psi2; gam2_ptr = gam2; h2_ptr = h2;
+	gradient(&TT,&n1,gam_ptr,&binsize,psi_ptr);
 	for (k=0; k<TT; k++)
 		psi1[k] = sqrt(fabs(psi1[k])+eps);
 
+	fc = mlogit_eval(TT, m, alpha, beta, ti, w, q, dq, y, psi_ptr, gam_ptr, h_ptr, evalwork);
+
 	do {
-		q_ptr = q; q_tmp_ptr = q_tmp;
-		q_tmp_diff_ptr = q_tmp_diff;
-		alpha_ptr = alpha; beta_ptr = beta;
+		if (!fresh)
+			fc = mlogit_eval(TT, m, alpha, beta, ti, w, q, dq, y, psi_ptr, gam_ptr, h_ptr, evalwork);
+		fresh = 0;
 
-		for (j=0; j<TT; j++)
-			xout[j] = (ti[TT-1] - ti[0])*gam_ptr[j]+ti[0];
-		xout_ptr = xout;
-		spline(TT, ti, q_ptr, TT, xout_ptr, q_tmp_ptr);
-
-		tmp_ptr = tmp;
-		gradient(m1,&n1,q_ptr,&binsize,tmp_ptr);
-		spline(TT, ti, tmp_ptr, TT, xout_ptr, q_tmp_diff_ptr);
-
-		A_ptr = A; Adiff_ptr = Adiff;
-		tmp2_ptr = tmp2; tmp1_ptr = &tmp1;
-		for (j=0; j<m; j++){
-			for (k=0; k<TT; k++)
-				tmp[k] = q_tmp_ptr[k]*psi_ptr[k]*beta_ptr[k];
-			tmp_ptr = tmp;
-			trapz(m1, &n1, ti, tmp_ptr, tmp1_ptr);
-			A[j] = tmp1;
-			for (k=0; k<TT; k++)
-				tmp[k] = q_tmp_diff_ptr[k]*psi_ptr[k]*beta_ptr[k];
-			tmp_ptr = tmp;
-			trapz(&TT, &n1, ti, tmp_ptr, tmp1_ptr);
-			cumtrapz(&TT, ti, tmp_ptr, tmp2_ptr);
-			for (k=0; k<TT; k++)
-				tmp[k] = tmp1_ptr[0] - tmp2_ptr[k];
-			tmp_ptr = tmp;
-			for (k=0; k<TT; k++)
-				Adiff_ptr[k] = 2*psi_ptr[k]*tmp_ptr[k]+q_tmp_ptr[k]*beta_ptr[k];
-
-			beta_ptr += TT;
-			Adiff_ptr += TT;
-		}
+		innerprod_q(&TT, ti, h_ptr, psi_ptr, &tmpi);
 
-		tmp1 = 0;
-		for (j=0; j<m; j++)
-			tmp1 += exp(alpha_ptr[j] + A_ptr[j]);
+		for (j=0; j<TT; j++)
+			vec[j] = h_ptr[j] - tmpi*psi_ptr[j];
 
-		tmp3_ptr = tmp3;
-		Adiff_ptr = Adiff;
-		for (j=0; j<m; j++){
-			for (k=0; k<TT; k++){
-				tmp3_ptr[k] = exp(alpha_ptr[j] + A_ptr[j]) * Adiff_ptr[k];
-			}
-			Adiff_ptr += TT;
-			tmp3_ptr += TT;
-		}
+		pvecnorm(&TT, vec, &binsize, &rn);
 
-		tmp_ptr = tmp;
-		tmp3_ptr = tmp3;
-		for (k=0; k<TT; k++){
-			tmp[k] = tmp3_ptr[k];
-			for (j=1; j<m; j++)
-				tmp[k] = tmp[k] + tmp3_ptr[k+j*TT];
-		}
+		max_val[itr] = fc;
 
-		for (k=0; k<TT; k++)
-			tmp[k] = tmp[k]/tmp1;
-
-		tmp3_ptr = tmp3;
-		Adiff_ptr = Adiff;
-		y_ptr = y;
-		for (j=0; j<m; j++){
-			for (k=0; k<TT; k++){
-				tmp3_ptr[k] = y_ptr[j] * Adiff_ptr[k];
-			}
-			Adiff_ptr += TT;
-			tmp3_ptr += TT;
-		}
+		if (display == 1)
+			printf("Iteration %d : Cost %f\n", itr, max_val[itr]);
 
-		h_ptr = h;
-		tmp3_ptr = tmp3;
-		for (k=0; k<TT; k++){
-			h[k] = tmp3_ptr[k];
-			for (j=1; j<m; j++)
-				h[k] += tmp3_ptr[k+j*TT];
-		}
+		if (step == WARP_STEP_FIXED){
+			sphere_exp(TT, psi_ptr, vec, rn, delta, psi2_ptr);
+			psi_to_gam(TT, ti, psi2_ptr, gam2_ptr);
 
-		tmp_ptr = tmp;
-		for (k=0; k<TT; k++)
-			h[k] = h[k] - tmp_ptr[k];
+			swap_ptr = psi_ptr; psi_ptr = psi2_ptr; psi2_ptr = swap_ptr;
+			swap_ptr = gam_ptr; gam_ptr = gam2_ptr; gam2_ptr = swap_ptr;
 
-		tmpi_ptr = &tmpi;
-		innerprod_q(m1, ti, h_ptr, psi_ptr, tmpi_ptr);
+			if (itr >= 2){
+				max_val_change = max_val[itr] - max_val[itr-1];
+				if (fabs(max_val_change) < tol)
+					break;
+				if (max_val_change < 0)
+					break;
+			}
+		}
+		else{
+			if (rn == 0)
+				break;
 
-		for (j=0; j<TT; j++)
-			vec[j] = h[j] - tmpi*psi_ptr[j];
+			slope = 0;
+			for (j=0; j<TT; j++)
+				slope += vec[j]*vec[j];
+			slope *= binsize;
+
+			st = warp_step_init(step, itr, delta, st, TT, binsize, vec, vprev);
+			for (ls=0; ls<WARP_MAX_BACKTRACK; ls++){
+				sphere_exp(TT, psi_ptr, vec, rn, st, psi2_ptr);
+				psi_to_gam(TT, ti, psi2_ptr, gam2_ptr);
+				f2 = mlogit_eval(TT, m, alpha, beta, ti, w, q, dq, y, psi2_ptr, gam2_ptr, h2_ptr, evalwork);
+				if (f2 >= fc + WARP_ARMIJO_C1*st*slope)
+					break;
+				st *= 0.5;
+			}
+			if (ls == WARP_MAX_BACKTRACK)
+				break;
 
-		psi2_ptr = psi2; gam2_ptr = gam2;
-		pvecnorm(&TT, vec, &binsize, &tmpi);
-		res_cos = cos(delta*tmpi);
-		res_sin = sin(delta*tmpi);
-		for (j=0; j<TT; j++)
-			psi2_ptr[j] = res_cos*psi_ptr[j] + res_sin*(vec[j]/tmpi);
+			for (j=0; j<TT; j++)
+				vprev[j] = vec[j];
+			swap_ptr = psi_ptr; psi_ptr = psi2_ptr; psi2_ptr = swap_ptr;
+			swap_ptr = gam_ptr; gam_ptr = gam2_ptr; gam2_ptr = swap_ptr;
+			swap_ptr = h_ptr; h_ptr = h2_ptr; h2_ptr = swap_ptr;
+			max_val_change = f2 - fc;
+			fc = f2;
+			fresh = 1;
 
-		for (j=0; j<TT; j++)
-			tmp[j] = psi2_ptr[j]*psi2_ptr[j];
+			if (max_val_change < tol)
+				break;
+		}
 
-		tmp_ptr = tmp;
-		cumtrapz(&TT,ti,tmp_ptr,gam2_ptr);
-		for (j=0; j<TT; j++)
-			gam2_ptr[j] = (gam2_ptr[j] - gam2_ptr[0])/(gam2_ptr[TT-1]-gam2_ptr[0]); // slight change of scale
+		itr++;
 
-		tmpi = 0;
-		alpha_ptr = alpha;
-		A_ptr = A;
-		for (j=0; j<m; j++)
-			tmpi += y[j] * (alpha_ptr[j] + A_ptr[j]);
+	} while (max_itr>=itr);
 
-		max_val[itr] = tmpi - log(tmp1);
+	for (k=0; k<TT; k++){
+		gamout[k] = gam_ptr[k];
+	}
 
-		if (display == 1)
-			printf("Iteration %d : Cost %f\n", itr, max_val[itr]);
+	free(work);
+}
 
-		gam_ptr = gam2;
-		psi_ptr = psi2;
+void mlogit_warp_grad(int *m1, int *m2, double *alpha, double *beta, double *ti, double *gami, double *q, int *y, int *max_itri, double *toli, double *deltai, int *displayi, double *gamout){
 
-		if (itr >= 2){
-			max_val_change = max_val[itr] - max_val[itr-1];
-			if (fabs(max_val_change) < tol)
-				break;
-			if (max_val_change < 0)
-				break;
-		}
+	// dereference inputs
+	// alpha, beta, q should be normalized by norm
+	mlogit_warp_grad1(*m1, *m2, alpha, beta, ti, gami, q, y, *max_itri, *toli, *deltai, *displayi, WARP_STEP_FIXED, gamout);
+}
 
-		itr++;
+void mlogit_warp_grad_step(int *m1, int *m2, double *alpha, double *beta, double *ti, double *gami, double *q, int *y, int *max_itri, double *toli, double *deltai, int *displayi, int *stepi, double *gamout){
 
-	} while (max_itr>=itr);
+	// dereference inputs
+	// alpha, beta, q should be normalized by norm
+	mlogit_warp_grad1(*m1, *m2, alpha, beta, ti, gami, q, y, *max_itri, *toli, *deltai, *displayi, *stepi, gamout);
+}
 
-	for (k=1; k<TT; k++){
-		gamout[k] = gam2_ptr[k];
-	}
+void mlogit_warp_grad_batch(int *m1, int *m2, int *n1, double *alpha, double *beta, double *ti, double *gami, double *q, int *y, int *max_itri, double *toli, double *deltai, int *displayi, int *stepi, int *nthreadsi, double *gamout){
 
-	free(tmp2);
+	// dereference inputs
+	// q is TT x N, y is m x N, gami and gamout are TT x N
+	int TT = *m1;
+	int m = *m2;
+	int N = *n1;
+	int max_itr = *max_itri;
+	double tol = *toli, delta = *deltai;
+	int display = *displayi;
+	int step = *stepi;
+	int nthreads = *nthreadsi;
+	int i;
+
+#ifdef _OPENMP
+	if (nthreads <= 0)
+		nthreads = omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+#else
+	(void)nthreads;
+#endif
+	for (i=0; i<N; i++)
+		mlogit_warp_grad1(TT, m, alpha, beta, ti, gami+i*TT, q+i*TT, y+i*m, max_itr, tol, delta, display, step, gamout+i*TT);
 }
@@ -1 +1,7 @@
 void mlogit_warp_grad(int *m1, int *m2, double *alpha, double *beta, double *ti, double *gami, double *q, int *y, int *max_itri, double *toli, double *deltai, int *displayi, double *gamout);
+
+/* Same with a step rule (WARP_STEP_FIXED, WARP_STEP_ARMIJO or WARP_STEP_BB) */
+void mlogit_warp_grad_step(int *m1, int *m2, double *alpha, double *beta, double *ti, double *gami, double *q, int *y, int *max_itri, double *toli, double *deltai, int *displayi, int *stepi, double *gamout);
+
+/* Batch version: warps the N columns of q (responses in the columns of y) on nthreads threads (0 = all) */
+void mlogit_warp_grad_batch(int *m1, int *m2, int *n1, double *alpha, double *beta, double *ti, double *gami, double *q, int *y, int *max_itri, double *toli, double *deltai, int *displayi, int *stepi, int *nthreadsi, double *gamout);
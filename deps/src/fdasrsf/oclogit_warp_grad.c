@@ -4,7 +4,14 @@
 #include <stdlib.h>
 #include "misc_funcs.h"
 
-void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, double *gamout, double *Oout){
+static double oclogit_cost(double *alpha, int *y, double A){
+	return log(1/(1+exp((-1*y[0])*(alpha[0]+A))));
+}
+
+/* With step WARP_STEP_FIXED the rotation and warp move by deltaO and deltag
+ * every iteration; the adaptive rules scale both steps together, backtrack
+ * until the Armijo condition holds and stop when the gain drops below tol. */
+static void oclogit_warp_grad1(int *n1, int *T1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, int step, double *gamout, double *Oout){
 
 	/* dereference inputs
 	alpha, beta, q should be normalized by norm */
@@ -15,7 +22,7 @@ void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, i
 	double display = *displayi;
 
 	// Looping and temp variables
-	int j, k, l, jj;
+	int j, k, l, jj, ls;
 	int p = 20;
 	int p1 = 10;
 	int itr = 0;
@@ -26,6 +33,7 @@ void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, i
 	double gam_tmp[TT], max_val[max_itr+1], tmp7[TT];
 	double binsize, A, theta, B, tmp1, tmp2, thetanew, tmpi;
 	double max_val_change, res_cos, res_sin, hO;
+	double q_trial[TT*n], hprev[TT], slope, st = deltag, f2;
 
 	// Pointers
 	double *t_ptr, *gam1_ptr, *f_basis_ptr, *q_tilde_ptr, *A_ptr, *nu_ptr;
@@ -48,6 +56,7 @@ void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, i
 	O1[1] = 0;
 	O1[2] = 0;
 	O1[3] = 1;
+	O1_ptr = O1;
 
 	// warping basis (fourier)
 	f_basis_ptr = f_basis;
@@ -138,6 +147,58 @@ void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, i
 		hpsi_ptr = hpsi;
 		pvecnorm(T1, hpsi_ptr, &binsize1, &tmpi);
 
+		if (step != WARP_STEP_FIXED){
+			max_val[itr] = oclogit_cost(alpha, y, A);
+
+			if (display == 1)
+				printf("Iteration %d : Cost %f\n", (itr+1), max_val[itr]);
+
+			slope = 0;
+			for (j=0; j<TT; j++)
+				slope += hpsi[j]*hpsi[j];
+			slope = deltaO*hO*hO + deltag*slope*binsize;
+			if (slope <= 0)
+				break;
+
+			// st is the warp step, the rotation moves by st/deltag*deltaO*hO
+			st = warp_step_init(step, itr+1, deltag, st, TT, binsize, hpsi, hprev);
+			for (ls=0; ls<WARP_MAX_BACKTRACK; ls++){
+				thetanew = theta+st/deltag*deltaO*hO;
+				O2[0] = cos(thetanew);
+				O2[1] = sin(thetanew);
+				O2[2] = -1*sin(thetanew);
+				O2[3] = cos(thetanew);
+
+				sphere_exp(TT, ones, hpsi, tmpi, st, psi);
+				psi_to_gam(TT, t, psi, gam_tmp);
+				approx_sorted(t, gam1, TT, gam_tmp, gam2, TT, 1, 0, 1, 0);
+
+				product(n, n, TT, O2, q, q_tmp);
+				group_action_by_gamma(n1, T1, q_tmp, gam2, q_trial);
+				f2 = oclogit_cost(alpha, y, innerprod_q2(T1, q_trial, nu));
+				if (f2 >= max_val[itr] + WARP_ARMIJO_C1*st/deltag*slope)
+					break;
+				st *= 0.5;
+			}
+			if (ls == WARP_MAX_BACKTRACK)
+				break;
+
+			for (j=0; j<TT; j++){
+				hprev[j] = hpsi[j];
+				gam1[j] = gam2[j];
+			}
+			for (k=0; k<n*n; k++)
+				O1[k] = O2[k];
+			for (k=0; k<TT*n; k++)
+				q_tilde[k] = q_trial[k];
+
+			if (f2 - max_val[itr] < tol)
+				break;
+
+			itr++;
+			continue;
+		}
+
 		res_cos = cos(deltag*tmpi);
 		res_sin = sin(deltag*tmpi);
 		if (tmpi == 0){
@@ -157,7 +218,7 @@ void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, i
 		for (j=0; j<TT; j++)
 			gam_tmp_ptr[j] = (gam_tmp_ptr[j] - gam_tmp_ptr[0])/(gam_tmp_ptr[TT-1]-gam_tmp_ptr[0]); // slight change of scale
 
-		approx(t, gam1_ptr, TT, gam_tmp_ptr, gam2_ptr, TT, 1, 0, 1, 0);
+		approx_sorted(t, gam1_ptr, TT, gam_tmp_ptr, gam2_ptr, TT, 1, 0, 1, 0);
 
 		y_ptr = y;
 		alpha_ptr = alpha;
@@ -198,3 +259,11 @@ void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, i
 	}
 
 }
+
+void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, double *gamout, double *Oout){
+	oclogit_warp_grad1(n1, T1, alpha, nu, q, y, max_itri, toli, deltaOi, deltagi, displayi, WARP_STEP_FIXED, gamout, Oout);
+}
+
+void oclogit_warp_grad_step(int *n1, int *T1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, int *stepi, double *gamout, double *Oout){
+	oclogit_warp_grad1(n1, T1, alpha, nu, q, y, max_itri, toli, deltaOi, deltagi, displayi, *stepi, gamout, Oout);
+}
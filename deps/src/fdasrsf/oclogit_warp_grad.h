@@ -1 +1,4 @@
 void oclogit_warp_grad(int *n1, int *T1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, double *gamout, double *Oout);
+
+/* Same with a step rule (WARP_STEP_FIXED, WARP_STEP_ARMIJO or WARP_STEP_BB) */
+void oclogit_warp_grad_step(int *n1, int *T1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, int *stepi, double *gamout, double *Oout);
@@ -2,9 +2,27 @@
 #include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "misc_funcs.h"
 
-void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, double *gamout, double *Oout){
+static double ocmlogit_cost(int m, double *alpha, int *y, double *A){
+	int j;
+	double tmp1 = 0, tmpi1 = 0;
+
+	for (j=0; j<m; j++){
+		tmp1 += exp(alpha[j] + A[j]);
+		tmpi1 += y[j] * (alpha[j] + A[j]);
+	}
+
+	return tmpi1 - log(tmp1);
+}
+
+/* With step WARP_STEP_FIXED the rotation and warp move by deltaO and deltag
+ * every iteration; the adaptive rules scale both steps together, backtrack
+ * until the Armijo condition holds and stop when the gain drops below tol. */
+static void ocmlogit_warp_grad1(int *n1, int *T1, int *m1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, int step, double *gamout, double *Oout){
 
 	/* dereference inputs
 	alpha, beta, q should be normalized by norm */
@@ -16,7 +34,7 @@ void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, do
 	double display = *displayi;
 
 	// Looping and temp variables
-	int k, j, l, kk, jj;
+	int k, j, l, kk, jj, ls;
 	int p = 20;
 	int p1 = 10;
 	int itr = 0;
@@ -29,6 +47,7 @@ void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, do
 	double tmp5[TT*p], tmp6[TT*m], tmp7[TT], tmp8[TT*m];
 	double hpsi[TT], ones[TT], psi[TT], gam2[TT], gam_tmp[TT];
 	double max_val_change, res_cos, res_sin, theta, thetanew;
+	double q_trial[TT*n], A2[m], hprev[TT], slope, st = deltag, f2;
 
 	// Pointers
 	double *t_ptr, *f_basis_ptr, *A_ptr, *tmpi_ptr, *q_tilde_ptr;
@@ -54,6 +73,7 @@ void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, do
 	O1[1] = 0;
 	O1[2] = 0;
 	O1[3] = 1;
+	O1_ptr = O1;
 
 	// warping basis (fourier)
 	f_basis_ptr = f_basis;
@@ -216,6 +236,63 @@ void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, do
 		gam_tmp_ptr = gam_tmp;
 		hpsi_ptr = hpsi;
 		pvecnorm(T1, hpsi_ptr, &binsize1, &tmpi);
+		if (step != WARP_STEP_FIXED){
+			max_val[itr] = ocmlogit_cost(m, alpha, y, A);
+
+			if (display == 1)
+				printf("Iteration %d : Cost %f\n", (itr+1), max_val[itr]);
+
+			slope = 0;
+			for (j=0; j<TT; j++)
+				slope += hpsi[j]*hpsi[j];
+			slope = deltaO*hO*hO + deltag*slope*binsize;
+			if (slope <= 0)
+				break;
+
+			// st is the warp step, the rotation moves by st/deltag*deltaO*hO
+			st = warp_step_init(step, itr+1, deltag, st, TT, binsize, hpsi, hprev);
+			for (ls=0; ls<WARP_MAX_BACKTRACK; ls++){
+				thetanew = theta+st/deltag*deltaO*hO;
+				O2[0] = cos(thetanew);
+				O2[1] = sin(thetanew);
+				O2[2] = -1*sin(thetanew);
+				O2[3] = cos(thetanew);
+
+				sphere_exp(TT, ones, hpsi, tmpi, st, psi);
+				psi_to_gam(TT, t, psi, gam_tmp);
+				approx_sorted(t, gam1, TT, gam_tmp, gam2, TT, 1, 0, 1, 0);
+
+				product(n, n, TT, O2, q, q_tmp);
+				group_action_by_gamma(n1, T1, q_tmp, gam2, q_trial);
+				nu_ptr = nu;
+				for (j=0; j<m; j++){
+					A2[j] = innerprod_q2(T1, q_trial, nu_ptr);
+					nu_ptr += n*TT;
+				}
+				f2 = ocmlogit_cost(m, alpha, y, A2);
+				if (f2 >= max_val[itr] + WARP_ARMIJO_C1*st/deltag*slope)
+					break;
+				st *= 0.5;
+			}
+			if (ls == WARP_MAX_BACKTRACK)
+				break;
+
+			for (j=0; j<TT; j++){
+				hprev[j] = hpsi[j];
+				gam1[j] = gam2[j];
+			}
+			for (k=0; k<n*n; k++)
+				O1[k] = O2[k];
+			for (k=0; k<TT*n; k++)
+				q_tilde[k] = q_trial[k];
+
+			if (f2 - max_val[itr] < tol)
+				break;
+
+			itr++;
+			continue;
+		}
+
 		res_cos = cos(deltag*tmpi);
 		res_sin = sin(deltag*tmpi);
 		for (j=0; j<TT; j++)
@@ -229,7 +306,7 @@ void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, do
 		for (j=0; j<TT; j++)
 			gam_tmp_ptr[j] = (gam_tmp_ptr[j] - gam_tmp_ptr[0])/(gam_tmp_ptr[TT-1]-gam_tmp_ptr[0]); // slight change of scale
 
-		approx(t, gam1_ptr, TT, gam_tmp_ptr, gam2_ptr, TT, 1, 0, 1, 0);
+		approx_sorted(t, gam1_ptr, TT, gam_tmp_ptr, gam2_ptr, TT, 1, 0, 1, 0);
 
 		tmpi1 = 0;
 		alpha_ptr = alpha;
@@ -274,3 +351,296 @@ void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, do
 	}
 
 }
+
+void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, double *gamout, double *Oout){
+	ocmlogit_warp_grad1(n1, T1, m1, alpha, nu, q, y, max_itri, toli, deltaOi, deltagi, displayi, WARP_STEP_FIXED, gamout, Oout);
+}
+
+void ocmlogit_warp_grad_step(int *n1, int *T1, int *m1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, int *stepi, double *gamout, double *Oout){
+	ocmlogit_warp_grad1(n1, T1, m1, alpha, nu, q, y, max_itri, toli, deltaOi, deltagi, displayi, *stepi, gamout, Oout);
+}
+
+/* Batch solver for curves in R^2 or R^3.
+ *
+ * The class terms are collapsed into one weighted template
+ * nubar = sum_j (y_j - p_j) nu_j, so the warp gradient coefficient on basis
+ * function f_k is <2 q' cbar_k + q f_k, nubar> = (2 Cbar' a + F' b)/TT with
+ * a_l = <q'_l, nubar_l>, b_l = <q_l, nubar_l>: two matrix-vector products with
+ * the basis F and its running integral Cbar, both computed once per call. The
+ * rotation moves along the skew part of M = sum_l nubar_l q_l' / TT, i.e.
+ * O2 = expm(deltaO*(M - M')) O1, which for n = 2 is the angle update of
+ * ocmlogit_warp_grad taken about the warped curve. The small kernels below are
+ * inlined with n as a constant so the inner loops are unrolled for n = 2, 3. */
+
+static inline double ocm_scores(const int n, int TT, int m, double *qt, double *nu, double *alpha, int *y, double *c, double *nubar){
+	int j, i;
+	double A, tmp1 = 0, tmpi1 = 0;
+
+	// c (m) is workspace
+	for (j=0; j<m; j++){
+		A = 0;
+		for (i=0; i<n*TT; i++)
+			A += qt[i]*nu[j*n*TT+i];
+		A = A/TT;
+		c[j] = exp(alpha[j] + A);
+		tmp1 += c[j];
+		tmpi1 += y[j] * (alpha[j] + A);
+	}
+
+	if (nubar != NULL){
+		for (i=0; i<n*TT; i++)
+			nubar[i] = 0;
+		for (j=0; j<m; j++){
+			c[j] = y[j] - c[j]/tmp1;
+			for (i=0; i<n*TT; i++)
+				nubar[i] += c[j]*nu[j*n*TT+i];
+		}
+	}
+
+	return tmpi1 - log(tmp1);
+}
+
+static inline void ocm_moments(const int n, int TT, double *qt, double *dqt, double *nubar, double *M, double *a, double *b){
+	int l, d, e;
+
+	for (d=0; d<n*n; d++)
+		M[d] = 0;
+	for (l=0; l<TT; l++){
+		a[l] = 0;
+		b[l] = 0;
+		for (d=0; d<n; d++){
+			a[l] += dqt[n*l+d]*nubar[n*l+d];
+			b[l] += qt[n*l+d]*nubar[n*l+d];
+			for (e=0; e<n; e++)
+				M[d+n*e] += nubar[n*l+d]*qt[n*l+e];
+		}
+	}
+	for (d=0; d<n*n; d++)
+		M[d] = M[d]/TT;
+}
+
+static inline void ocm_rotate(const int n, double *M, double deltaO, double *O1, double *O2){
+	int d, e;
+	double R[9], X[9], X2[9], th, a, b;
+
+	if (n == 2){
+		th = deltaO*(M[1] - M[2]);
+		R[0] = cos(th);
+		R[1] = sin(th);
+		R[2] = -1*sin(th);
+		R[3] = cos(th);
+	}
+	else{
+		// Rodrigues formula for expm(X), X = deltaO*(M - M')
+		for (d=0; d<3; d++)
+			for (e=0; e<3; e++)
+				X[d+3*e] = deltaO*(M[d+3*e] - M[e+3*d]);
+		th = sqrt(X[5]*X[5] + X[6]*X[6] + X[1]*X[1]);
+		a = (th > 0) ? sin(th)/th : 1;
+		b = (th > 0) ? (1-cos(th))/(th*th) : 0.5;
+		product(3, 3, 3, X, X, X2);
+		for (d=0; d<9; d++)
+			R[d] = a*X[d] + b*X2[d];
+		R[0] += 1;
+		R[4] += 1;
+		R[8] += 1;
+	}
+
+	product(n, n, n, R, O1, O2);
+}
+
+static inline void ocm_keep_best(const int n, int TT, double fc, double *gam, double *O, double *fbest, double *gbest, double *Obest){
+	int k;
+
+	if (fc <= *fbest)
+		return;
+	*fbest = fc;
+	for (k=0; k<TT; k++)
+		gbest[k] = gam[k];
+	for (k=0; k<n*n; k++)
+		Obest[k] = O[k];
+}
+
+static inline void ocmlogit_warp_grad1n(const int n, int TT, int m, int p, double *t, double *F, double *Cbar, double *alpha, double *nu, double *q, int *y, int max_itr, double tol, double deltaO, double deltag, int display, int step, double *gamout, double *Oout){
+
+	// Looping and temp variables
+	int k, j, l, ls;
+	int itr = 0;
+	int nn = n;
+	double binsize = 1.0/(TT-1);
+	double O1[9], O2[9], M[9], Obest[9];
+	double fc, fbest = -DBL_MAX, f2, hO, hn, slope, st = deltag;
+
+	// the buffers are on the heap, the stacks of the worker threads are small
+	double *work = malloc(sizeof(double)*(5*n*TT + 11*TT + p + m));
+	double *qt = work, *dqt = qt + n*TT, *q_tmp = dqt + n*TT, *q_trial = q_tmp + n*TT, *nubar = q_trial + n*TT;
+	double *a = nubar + n*TT, *b = a + TT, *hpsi = b + TT, *hprev = hpsi + TT, *ones = hprev + TT, *psi = ones + TT;
+	double *gam1 = psi + TT, *gam2 = gam1 + TT, *gam_tmp = gam2 + TT, *gbest = gam_tmp + TT;
+	double *coef = gbest + TT, *cm = coef + p;
+
+	for (k=0; k<n*n; k++)
+		O1[k] = (k % (n+1) == 0) ? 1 : 0;
+	for (k=0; k<TT; k++){
+		gam1[k] = t[k];
+		ones[k] = 1.0;
+	}
+	for (k=0; k<TT*n; k++)
+		qt[k] = q[k];
+
+	do {
+		fc = ocm_scores(n, TT, m, qt, nu, alpha, y, cm, nubar);
+		ocm_keep_best(n, TT, fc, gam1, O1, &fbest, gbest, Obest);
+
+		col_gradient(n, TT, qt, binsize, dqt);
+		ocm_moments(n, TT, qt, dqt, nubar, M, a, b);
+
+		// coef = (2 Cbar' a + F' b)/TT, hpsi = F coef
+		for (k=0; k<p; k++){
+			coef[k] = 0;
+			for (l=0; l<TT; l++)
+				coef[k] += 2*Cbar[l+k*TT]*a[l] + F[l+k*TT]*b[l];
+			coef[k] = coef[k]/TT;
+		}
+		for (l=0; l<TT; l++)
+			hpsi[l] = 0;
+		for (k=0; k<p; k++)
+			for (l=0; l<TT; l++)
+				hpsi[l] += coef[k]*F[l+k*TT];
+
+		hn = 0;
+		for (l=0; l<TT; l++)
+			hn += hpsi[l]*hpsi[l];
+		hn = sqrt(hn);
+		hO = 0;
+		for (j=0; j<n; j++)
+			for (k=0; k<n; k++)
+				hO += 0.5*(M[j+n*k] - M[k+n*j])*(M[j+n*k] - M[k+n*j]);
+		hO = sqrt(hO);
+
+		if (display == 1)
+			printf("Iteration %d : Cost %f\n", (itr+1), fc);
+
+		if (step == WARP_STEP_FIXED){
+			ocm_rotate(n, M, deltaO, O1, O2);
+			sphere_exp(TT, ones, hpsi, hn, deltag, psi);
+			psi_to_gam(TT, t, psi, gam_tmp);
+			approx_sorted(t, gam1, TT, gam_tmp, gam2, TT, 1, 0, 1, 0);
+
+			for (k=0; k<n*n; k++)
+				O1[k] = O2[k];
+			for (k=0; k<TT; k++)
+				gam1[k] = gam2[k];
+			product(n, n, TT, O1, q, q_tmp);
+			group_action_by_gamma(&nn, &TT, q_tmp, gam1, qt);
+
+			if (hO < tol && hn < tol)
+				break;
+		}
+		else{
+			slope = 0;
+			for (l=0; l<TT; l++)
+				slope += hpsi[l]*hpsi[l];
+			slope = deltaO*hO*hO + deltag*slope*binsize;
+			if (slope <= 0)
+				break;
+
+			st = warp_step_init(step, itr+1, deltag, st, TT, binsize, hpsi, hprev);
+			for (ls=0; ls<WARP_MAX_BACKTRACK; ls++){
+				ocm_rotate(n, M, st/deltag*deltaO, O1, O2);
+				sphere_exp(TT, ones, hpsi, hn, st, psi);
+				psi_to_gam(TT, t, psi, gam_tmp);
+				approx_sorted(t, gam1, TT, gam_tmp, gam2, TT, 1, 0, 1, 0);
+
+				product(n, n, TT, O2, q, q_tmp);
+				group_action_by_gamma(&nn, &TT, q_tmp, gam2, q_trial);
+				f2 = ocm_scores(n, TT, m, q_trial, nu, alpha, y, cm, NULL);
+				if (f2 >= fc + WARP_ARMIJO_C1*st/deltag*slope)
+					break;
+				st *= 0.5;
+			}
+			if (ls == WARP_MAX_BACKTRACK)
+				break;
+
+			for (k=0; k<n*n; k++)
+				O1[k] = O2[k];
+			for (k=0; k<TT; k++){
+				gam1[k] = gam2[k];
+				hprev[k] = hpsi[k];
+			}
+			for (k=0; k<TT*n; k++)
+				qt[k] = q_trial[k];
+
+			if (f2 - fc < tol)
+				break;
+		}
+
+		itr++;
+
+	} while (max_itr>=itr);
+
+	// the fixed steps may go downhill, so the best iterate is returned
+	fc = ocm_scores(n, TT, m, qt, nu, alpha, y, cm, NULL);
+	ocm_keep_best(n, TT, fc, gam1, O1, &fbest, gbest, Obest);
+
+	for (k=0; k<TT; k++)
+		gamout[k] = gbest[k];
+
+	for (k=0; k<n*n; k++)
+		Oout[k] = Obest[k];
+
+	free(work);
+}
+
+void ocmlogit_warp_grad_batch(int *n1, int *T1, int *m1, int *N1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, int *stepi, int *nthreadsi, double *gamout, double *Oout){
+
+	/* dereference inputs
+	q is n x TT x N, y is m x N, gamout is TT x N and Oout is n x n x N */
+	int TT = *T1;  // number of sample points
+	int m = *m1;  // number of classes
+	int n = *n1;  // number of dimension of curves R^n
+	int N = *N1;  // number of curves
+	int max_itr = *max_itri;
+	double tol = *toli, deltaO = *deltaOi, deltag = *deltagi;
+	int display = *displayi, step = *stepi, nthreads = *nthreadsi;
+
+	// Looping and temp variables
+	int i, j, k;
+	int p = 20;
+	int p1 = 10;
+	double *F, *Cbar, *t;
+
+	if (n != 2 && n != 3){
+		printf("ocmlogit_warp_grad_batch: curves must be in R^2 or R^3.\n");
+		return;
+	}
+
+	// warping basis (fourier) and its running integral, shared by all curves
+	F = malloc(sizeof(double)*(2*TT*p + TT));
+	Cbar = F + TT*p;
+	t = Cbar + TT*p;
+	linspace(0, 1, TT, t);
+	for (k=0; k<p1; k++){
+		for (j=0; j<TT; j++){
+			F[j+2*k*TT] = 1/sqrt(M_PI) * sin(2*M_PI*(k+1)*t[j]);
+			F[j+(2*k+1)*TT] = 1/sqrt(M_PI) * cos(2*M_PI*(k+1)*t[j]);
+		}
+	}
+	for (k=0; k<p; k++)
+		cumtrapz(T1, t, F+k*TT, Cbar+k*TT);
+
+#ifdef _OPENMP
+	if (nthreads <= 0)
+		nthreads = omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+#else
+	(void)nthreads;
+#endif
+	for (i=0; i<N; i++){
+		if (n == 2)
+			ocmlogit_warp_grad1n(2, TT, m, p, t, F, Cbar, alpha, nu, q+i*2*TT, y+i*m, max_itr, tol, deltaO, deltag, display, step, gamout+i*TT, Oout+i*4);
+		else
+			ocmlogit_warp_grad1n(3, TT, m, p, t, F, Cbar, alpha, nu, q+i*3*TT, y+i*m, max_itr, tol, deltaO, deltag, display, step, gamout+i*TT, Oout+i*9);
+	}
+
+	free(F);
+}
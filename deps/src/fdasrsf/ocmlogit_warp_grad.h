@@ -1 +1,7 @@
 void ocmlogit_warp_grad(int *n1, int *T1, int *m1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, double *gamout, double *Oout);
+
+/* Same with a step rule (WARP_STEP_FIXED, WARP_STEP_ARMIJO or WARP_STEP_BB) */
+void ocmlogit_warp_grad_step(int *n1, int *T1, int *m1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, int *stepi, double *gamout, double *Oout);
+
+/* Batch version for N curves in R^2 or R^3 on nthreads threads (0 = all) */
+void ocmlogit_warp_grad_batch(int *n1, int *T1, int *m1, int *N1, double *alpha, double *nu, double *q, int *y, int *max_itri, double *toli, double *deltaOi, double *deltagi, int *displayi, int *stepi, int *nthreadsi, double *gamout, double *Oout);
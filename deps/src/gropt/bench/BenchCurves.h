@@ -0,0 +1,108 @@
+/*
+This file defines the synthetic pairs of curves of the benchmark and of the checks of DriverElasticCurvesRO,
+such that both run on the same curves.
+*/
+
+#ifndef BENCHCURVES_H
+#define BENCHCURVES_H
+
+#include "DriverElasticCurvesRO.h"
+#include "def.h"
+
+using namespace ROPTLIB;
+
+/*The number of harmonics of the synthetic curves*/
+#define BENCHHARMONICS 4
+
+/*Evaluate the synthetic curve with coefficients coefs (d x BENCHHARMONICS x 2) at the parameter t.
+A closed curve is a trigonometric polynomial of period 1 around an ellipse, an open curve
+is a cosine polynomial on [0, 1] along the first axis.*/
+inline void BenchCurvePoint(const double *coefs, integer d, bool isclosed, double t, double *p)
+{
+	for (integer j = 0; j < d; j++)
+	{
+		const double *cj = coefs + j * BENCHHARMONICS * 2;
+		if (isclosed)
+			p[j] = (j == 0) ? cos(2 * PI * t) : ((j == 1) ? 0.7 * sin(2 * PI * t) : 0);
+		else
+			p[j] = (j == 0) ? t : 0;
+		for (integer k = 1; k <= BENCHHARMONICS; k++)
+		{
+			if (isclosed)
+				p[j] += cj[2 * k - 2] * cos(2 * PI * k * t) + cj[2 * k - 1] * sin(2 * PI * k * t);
+			else
+				p[j] += cj[2 * k - 2] * cos(PI * k * t);
+		}
+	}
+};
+
+/*Generate the pair of curves C1 and C2 (d x n, stored as n x d) of one case. C2 is C1 evaluated at
+the warping gamma(t) = t + a sin(2 pi t) / (2 pi), shifted by half a period if isclosed and rotated.
+The curves only depend on seed, d and isclosed, and are centered and of unit norm.*/
+inline void BenchCurves(unsigned int seed, integer d, integer n, bool isclosed, double *C1, double *C2)
+{
+	RandGenContext ctx;
+	genrandseed(&ctx, seed + 16 * static_cast<unsigned int> (d) + ((isclosed) ? 1 : 0));
+
+	double coefs[3 * BENCHHARMONICS * 2], p[3], q[3], O[9];
+	for (integer j = 0; j < d; j++)
+	{
+		for (integer k = 1; k <= BENCHHARMONICS; k++)
+		{
+			coefs[j * BENCHHARMONICS * 2 + 2 * k - 2] = 0.3 * genrandnormal(&ctx) / (k * k);
+			coefs[j * BENCHHARMONICS * 2 + 2 * k - 1] = 0.3 * genrandnormal(&ctx) / (k * k);
+		}
+	}
+	double a = 0.3 + 0.4 * genrandreal(&ctx);
+	double shift = (isclosed) ? 0.5 : 0;
+
+	// the rotation about the unit axis u by the angle theta (Rodrigues' formula), about e_3 if d = 2
+	double theta = PI * (2 * genrandreal(&ctx) - 1);
+	double u[3] = { 0, 0, 1 };
+	if (d == 3)
+	{
+		double nu = 0;
+		for (integer j = 0; j < 3; j++)
+		{
+			u[j] = genrandnormal(&ctx);
+			nu += u[j] * u[j];
+		}
+		nu = sqrt(nu);
+		for (integer j = 0; j < 3; j++)
+			u[j] /= nu;
+	}
+	for (integer j = 0; j < 3; j++)
+	{
+		for (integer k = 0; k < 3; k++)
+		{
+			O[j + k * 3] = (1 - cos(theta)) * u[j] * u[k] + ((j == k) ? cos(theta) : 0);
+		}
+	}
+	O[1] += sin(theta) * u[2]; O[3] -= sin(theta) * u[2];
+	O[2] -= sin(theta) * u[1]; O[6] += sin(theta) * u[1];
+	O[5] += sin(theta) * u[0]; O[7] -= sin(theta) * u[0];
+
+	for (integer i = 0; i < n; i++)
+	{
+		double t = static_cast<double> (i) / (n - 1);
+		BenchCurvePoint(coefs, d, isclosed, t, p);
+		for (integer j = 0; j < d; j++)
+			C1[i + j * n] = p[j];
+
+		BenchCurvePoint(coefs, d, isclosed, t + a * sin(2 * PI * t) / (2 * PI) + shift, p);
+		for (integer j = 0; j < d; j++)
+		{
+			q[j] = 0;
+			for (integer k = 0; k < d; k++)
+				q[j] += O[j + k * 3] * p[k];
+		}
+		for (integer j = 0; j < d; j++)
+			C2[i + j * n] = q[j];
+	}
+	CenterC(C1, d, n);
+	NormalizedC(C1, d, n);
+	CenterC(C2, d, n);
+	NormalizedC(C2, d, n);
+};
+
+#endif // end of BENCHCURVES_H
@@ -0,0 +1,180 @@
+/*
+This is the benchmark of DriverElasticCurvesRO. It generates deterministic synthetic pairs of curves
+(open or closed, d = 2 or 3) and times the driver for each solver and for the Dynamic Programming only
+(onlyDP) method. The results are written to the standard output as comma separated values, one line per case.
+
+Build it by "make bench" and run
+	./bench/BenchElasticCurvesRO [-n 100,500] [-d 2,3] [-c open,closed]
+		[-m RBFGS,LRBFGS,RCG,RSD,RTRSR1,LRTRSR1,RTRSD,DP] [-r 3] [-p 1] [-k 4] [-s 1] [-o file]
+where -n, -d, -c and -m are the lists of numbers of points, dimensions, curve types and methods, -r is the
+number of repetitions of each case, -p the number of threads used by the driver, -k the skipm of the driver,
+-s the seed of the curves and -o the file the results are written to, since the solvers may print warnings on
+the standard output. The generator supports any n >= 10; note that DP on closed curves tries (n - 1) / skipm
+shifts with a dense Dynamic Programming each, e.g., -n 2000 -c closed -m DP -k 100.
+The times are the minimum and the median wall time over the repetitions, and the last six columns are the
+mean solver telemetry (SolverTelemetry) of one repetition.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "BenchCurves.h"
+
+using namespace ROPTLIB;
+
+/*The methods that can be benchmarked. "DP" is the Dynamic Programming only method, i.e., onlyDP = true.*/
+static const char *BenchMethods[] = { "RBFGS", "LRBFGS", "RCG", "RSD", "RTRSR1", "LRTRSR1", "RTRSD", "DP" };
+static const integer NumBenchMethods = 8;
+
+/*The number of telemetry records kept, i.e., the maximum number of iterations set by the driver plus one*/
+#define BENCHRECORDS 501
+
+/*Split the comma separated list str into tokens*/
+static std::vector<std::string> BenchSplit(const char *str)
+{
+	std::vector<std::string> result;
+	std::string s(str);
+	std::string::size_type start = 0, end;
+	while ((end = s.find(',', start)) != std::string::npos)
+	{
+		if (end > start)
+			result.push_back(s.substr(start, end - start));
+		start = end + 1;
+	}
+	if (start < s.size())
+		result.push_back(s.substr(start));
+	return result;
+};
+
+int main(int argc, char *argv[])
+{
+	std::vector<std::string> ns = BenchSplit("100,500");
+	std::vector<std::string> ds = BenchSplit("2,3");
+	std::vector<std::string> types = BenchSplit("open,closed");
+	std::vector<std::string> methods(BenchMethods, BenchMethods + NumBenchMethods);
+	integer reps = 3, nthreads = 1, skipm = 4;
+	unsigned int seed = 1;
+	FILE *out = stdout;
+
+	for (integer i = 1; i < argc; i++)
+	{
+		if (i + 1 >= argc || argv[i][0] != '-' || strlen(argv[i]) != 2)
+		{
+			printf("Usage: %s [-n list] [-d list] [-c list] [-m list] [-r reps] [-p threads] [-k skipm] [-s seed] [-o file]\n", argv[0]);
+			return 1;
+		}
+		const char *value = argv[++i];
+		switch (argv[i - 1][1])
+		{
+		case 'n': ns = BenchSplit(value); break;
+		case 'd': ds = BenchSplit(value); break;
+		case 'c': types = BenchSplit(value); break;
+		case 'm': methods = BenchSplit(value); break;
+		case 'r': reps = atol(value); break;
+		case 'p': nthreads = atol(value); break;
+		case 'k': skipm = atol(value); break;
+		case 's': seed = static_cast<unsigned int> (atol(value)); break;
+		case 'o':
+			out = fopen(value, "w");
+			if (out == nullptr)
+			{
+				printf("Cannot open %s\n", value);
+				return 1;
+			}
+			break;
+		default:
+			printf("Unknown option %s\n", argv[i - 1]);
+			return 1;
+		}
+	}
+	reps = (reps < 1) ? 1 : reps;
+	for (size_t m = 0; m < methods.size(); m++)
+	{
+		if (std::find(BenchMethods, BenchMethods + NumBenchMethods, methods[m]) == BenchMethods + NumBenchMethods)
+		{
+			printf("Unknown method %s\n", methods[m].c_str());
+			return 1;
+		}
+	}
+
+	fprintf(out, "method,d,n,curve,reps,threads,min_s,median_s,fopt,starts,ns,iters,f_s,grad_s,funcgrad_s,retraction_s,transport_s,linesearch_s\n");
+	for (size_t t = 0; t < types.size(); t++)
+	{
+		bool isclosed = (types[t] == "closed");
+		if (!isclosed && types[t] != "open")
+		{
+			printf("Unknown curve type %s\n", types[t].c_str());
+			return 1;
+		}
+		for (size_t id = 0; id < ds.size(); id++)
+		{
+			integer d = atol(ds[id].c_str());
+			if (d != 2 && d != 3)
+			{
+				printf("The dimension must be 2 or 3\n");
+				return 1;
+			}
+			for (size_t in = 0; in < ns.size(); in++)
+			{
+				integer n = atol(ns[in].c_str());
+				if (n < 10)
+				{
+					printf("The number of points must be at least 10\n");
+					return 1;
+				}
+				double *C1 = new double[2 * d * n];
+				double *C2 = C1 + d * n;
+				BenchCurves(seed, d, n, isclosed, C1, C2);
+
+				L2SphereVariable FNSV(n);
+				OrthGroupVariable OGV(d);
+				EucVariable EucV(1);
+				ProductElement Xopt(3, &FNSV, 1, &OGV, 1, &EucV, 1);
+				double *records = new double[BENCHRECORDS * TELERECORDLENGTH];
+
+				for (size_t m = 0; m < methods.size(); m++)
+				{
+					bool onlyDP = (methods[m] == "DP");
+					std::string solverstr = (onlyDP) ? "" : methods[m];
+					std::vector<double> times(reps);
+					double fopts[5], comtime[5];
+					integer Nsout = 0, numinitialx = 0;
+					bool swap;
+					SolverTelemetry telemetry;
+					for (integer j = 0; j < TELEOPLENGTH; j++)
+						telemetry.times[j] = 0;
+					DriverElasticCurvesROOptions options;
+					options.nthreads = nthreads;
+					options.telemetry = &telemetry;
+
+					for (integer r = 0; r < reps; r++)
+					{
+						telemetry.records = records;
+						telemetry.capacity = BENCHRECORDS;
+						telemetry.length = 0;
+						genrandseed(0);
+						unsigned long starttime = getTickCount();
+						DriverElasticCurvesRO(C1, C2, d, n, 0.01, true, isclosed, onlyDP, skipm, solverstr, 0, &Xopt, swap,
+							fopts, comtime, Nsout, numinitialx, nullptr, nullptr, options);
+						times[r] = static_cast<double>(getTickCount() - starttime) / CLK_PS;
+					}
+					std::sort(times.begin(), times.end());
+					integer iters = (telemetry.length > 0) ? static_cast<integer> (records[(telemetry.length - 1) * TELERECORDLENGTH]) : 0;
+
+					fprintf(out, "%s,%ld,%ld,%s,%ld,%ld,%.6e,%.6e,%.10e,%ld,%ld,%ld", methods[m].c_str(), d, n, types[t].c_str(),
+						reps, nthreads, times[0], times[reps / 2], fopts[0], numinitialx, Nsout, iters);
+					for (integer j = 0; j < TELEOPLENGTH; j++)
+						fprintf(out, ",%.6e", telemetry.times[j] / reps);
+					fprintf(out, "\n");
+					fflush(out);
+				}
+				delete[] records;
+				delete[] C1;
+			}
+		}
+	}
+	if (out != stdout)
+		fclose(out);
+	return 0;
+};
@@ -0,0 +1,358 @@
+/*
+This is the check of DriverElasticCurvesRO and of the functions around it. It runs them on the synthetic curves of
+the benchmark (BenchCurves.h) and compares results that must agree:
+	batch:    optimum_reparam_batch and optimum_reparam called for each curve, bit for bit, for open and closed
+	          curves in R^2 and R^3, one template or pairs of curves, and all the autoselectC;
+	manifold: LRBFGS on the flat ElasticCurvesManifold and on the ProductManifold of L2Sphere, OrthGroup and Euclidean,
+	          from the same Dynamic Programming seeds of closed curves in R^3;
+	reset:    the starts of ElasticCurvesROStart with a solver reused through Solvers::Reset and with a new solver,
+	          bit for bit;
+	rotation: for open curves in R^3, the rotation in opt and the best rotation of the warped q2 to q1;
+	cost:     for the same curves, fopts and the cost recomputed from opt;
+	warm:     optimum_reparam_warm started from its own optimum is accepted (warm = 1) and the cost does not increase;
+	bestrot:  BestRotation2 and BestRotation3 and the rotation given by the singular value decomposition.
+
+Build and run it by "make check". Each check prints its largest error and its tolerance, and the program returns the
+number of failed checks. The solvers may print warnings on the standard output.
+*/
+
+#include <cstdio>
+#include <algorithm>
+#include "BenchCurves.h"
+#include "ElasticCurvesReparam.h"
+#include "ElasticCurvesManifold.h"
+#include "ElasticCurvesVariable.h"
+
+using namespace ROPTLIB;
+
+/*Print the result of a check and return 1 if it failed. A NaN error fails.*/
+static integer CheckReport(const char *name, double err, double tol)
+{
+	bool passed = (err <= tol);
+	printf("%-9s max error %.3e, tolerance %.1e: %s\n", name, err, tol, (passed) ? "passed" : "FAILED");
+	return (passed) ? 0 : 1;
+};
+
+/*The largest absolute difference between the arrays a and b of length len*/
+static double CheckMaxDiff(const double *a, const double *b, integer len)
+{
+	double result = 0;
+	for (integer i = 0; i < len; i++)
+		result = std::max(result, fabs(a[i] - b[i]));
+	return result;
+};
+
+/*optimum_reparam_batch on K curves against optimum_reparam for each of them.*/
+static double CheckBatch(int n, int K)
+{
+	double err = 0;
+	for (int c = 0; c < 2; c++)
+	{
+		bool isclosed = (c == 1);
+		for (int d = 2; d <= 3; d++)
+		{
+			int sizex = n + d * d + 1;
+			double *C1 = new double[2 * d * n * K];
+			double *C2 = C1 + d * n * K;
+			for (int k = 0; k < K; k++)
+				BenchCurves(k + 1, d, n, isclosed, C1 + k * d * n, C2 + k * d * n);
+
+			double *opt = new double[sizex * (K + 1)];
+			double *opt1 = opt + sizex * K;
+			double *fopts = new double[10 * K + 10];
+			double *comtime = fopts + 5 * K, *fopts1 = comtime + 5 * K, *comtime1 = fopts1 + 5;
+			int *swap = new int[K];
+			for (int autoselectC = 0; autoselectC <= 2; autoselectC++)
+			{
+				for (int p = 0; p < 2; p++)
+				{
+					bool pairs = (p == 1);
+					for (int i = 0; i < 5 * K; i++)
+						fopts[i] = 0;
+					optimum_reparam_batch(C1, C2, n, d, K, pairs, 0.01, false, true, isclosed, 4, autoselectC, K,
+						opt, swap, fopts, comtime);
+					for (int k = 0; k < K; k++)
+					{
+						for (int i = 0; i < 5; i++)
+							fopts1[i] = 0;
+						optimum_reparam((pairs) ? C1 + k * d * n : C1, C2 + k * d * n, n, d, 0.01, false, true, isclosed, 4,
+							autoselectC, opt1, false, fopts1, comtime1);
+						err = std::max(err, CheckMaxDiff(opt + k * sizex, opt1, sizex));
+						err = std::max(err, CheckMaxDiff(fopts + 5 * k, fopts1, 5));
+					}
+				}
+			}
+			delete[] swap;
+			delete[] fopts;
+			delete[] opt;
+			delete[] C1;
+		}
+	}
+	return err;
+};
+
+/*The coarse square root velocity function q1s (d x ns) of C1 used by the seeds, in C1s (2 * d * ns) as in the driver*/
+static double *CheckCoarseQ(const double *C1, integer d, integer n, bool isclosed, integer &ns)
+{
+	ns = CoarseNumPoints(n, (isclosed) ? ComputeTotalAngle(C1, d, n) : 0);
+	double *C1s = new double[2 * d * ns];
+	GetCurveSmall(C1, C1s, d, n, ns, isclosed);
+	CurveToQ(C1s, d, ns, C1s + d * ns, isclosed);
+	return C1s;
+};
+
+/*LRBFGS on the flat ElasticCurvesManifold and on the ProductManifold from the same seeds of closed curves in R^3.
+The two manifolds represent the same domain and the same retraction and transport, so the costs and iterates agree up to
+rounding errors.*/
+static double CheckManifold(integer n, integer numcurves)
+{
+	integer d = 3, ns;
+	double err = 0;
+	double *C1 = new double[2 * d * n + d * n + n + 2 * (n + d * d + 1)];
+	double *C2 = C1 + d * n, *q1 = C2 + d * n, *l = q1 + d * n, *Xs = l + n, *Xsp = Xs + n + d * d + 1;
+	for (integer k = 0; k < numcurves; k++)
+	{
+		BenchCurves(static_cast<unsigned int> (k + 1), d, n, true, C1, C2);
+		CurveToQ(C1, d, n, q1, true);
+		double *C1s = CheckCoarseQ(C1, d, n, true, ns);
+		integer lwork = 4 * d * n + n + 3 * d * d + 2 * d * ns + ns;
+		double *work = new double[lwork + d * n + d * d];
+		double *Rotq2shift = work + lwork, *O2 = Rotq2shift + d * n;
+		for (integer ms = 0; ms < n - 1; ms += n / 3)
+		{
+			ElasticCurvesROSeed(C2, nullptr, q1, C1s + d * ns, d, n, ns, true, true, false, ms, work);
+			// work holds O (d x d) after its first 2 * d * n entries, then the shifted and rotated q2 and DPgam
+			double *O = work + 2 * d * n, *DPgam = O + d * d + 2 * d * n;
+			GradientPeriod(DPgam, n, 1.0 / (n - 1), l);
+			double f[2];
+			for (integer m = 0; m < 2; m++)
+			{
+				L2Sphere TNS(n);
+				OrthGroup OG(d);
+				Euclidean Euc(1);
+				L2SphereVariable TNSV(n);
+				OrthGroupVariable OGV(d);
+				EucVariable EucV(1);
+				Manifold *Domain = nullptr;
+				Variable *InitialX = nullptr;
+				if (m == 0)
+				{
+					Domain = NewElasticCurvesManifold(n, d);
+					InitialX = new ElasticCurvesVariable(n, d);
+				}
+				else
+				{
+					Domain = new ProductManifold(3, &TNS, 1, &OG, 1, &Euc, 1);
+					InitialX = new ProductElement(3, &TNSV, 1, &OGV, 1, &EucV, 1);
+				}
+				double *Xptr = InitialX->ObtainWriteEntireData();
+				for (integer i = 0; i < n; i++)
+					Xptr[i] = sqrt(l[i]);
+				for (integer i = 0; i < d * d; i++)
+					Xptr[n + i] = (i % (d + 1) == 0) ? 1 : 0;
+				Xptr[n + d * d] = 0;
+				// the problem may overwrite the shifted and rotated q2
+				integer len = d * n;
+				dcopy_(&len, O + d * d, &GLOBAL::IONE, Rotq2shift, &GLOBAL::IONE);
+				ElasticCurvesROSolve(q1, Rotq2shift, O, d, n, 0.01, true, true, ms, "LRBFGS", Domain, InitialX, O2,
+					(m == 0) ? Xs : Xsp, f[m], nullptr);
+				delete InitialX;
+				delete Domain;
+			}
+			err = std::max(err, fabs(f[0] - f[1]));
+			err = std::max(err, CheckMaxDiff(Xs, Xsp, n + d * d + 1));
+		}
+		delete[] work;
+		delete[] C1s;
+	}
+	delete[] C1;
+	return err;
+};
+
+/*The starts of ElasticCurvesROStart from several break points with one solver reused through Solvers::Reset and with
+a new solver for each start, for closed curves in R^2 and R^3 and several solvers. A solver cached for n points is not
+reset for n / 2 points, but must be replaced by a new solver.*/
+static double CheckReset(integer n)
+{
+	const char *solvers[] = { "LRBFGS", "RBFGS", "RCG", "LRTRSR1" };
+	double err = 0;
+	for (integer d = 2; d <= 3; d++)
+	{
+		integer ns, nh = n / 2, nsh, sizex = n + d * d + 1;
+		double *C1 = new double[2 * d * n + d * n + 2 * sizex + 2 * d * nh + d * nh];
+		double *C2 = C1 + d * n, *q1 = C2 + d * n, *Xs = q1 + d * n, *Xsc = Xs + sizex;
+		double *C1h = Xsc + sizex, *C2h = C1h + d * nh, *q1h = C2h + d * nh;
+		BenchCurves(1, d, n, true, C1, C2);
+		CurveToQ(C1, d, n, q1, true);
+		double *C1s = CheckCoarseQ(C1, d, n, true, ns);
+		BenchCurves(2, d, nh, true, C1h, C2h);
+		CurveToQ(C1h, d, nh, q1h, true);
+		double *C1sh = CheckCoarseQ(C1h, d, nh, true, nsh);
+		integer lwork = 4 * d * n + n + 3 * d * d + 2 * d * ns + ns;
+		double *work = new double[lwork];
+		for (integer s = 0; s < 4; s++)
+		{
+			Solvers *cache = nullptr;
+			for (integer ms = 0; ms < n - 1; ms += n / 4)
+			{
+				double f, fc;
+				ElasticCurvesROStart(C2, nullptr, q1, C1s + d * ns, d, n, ns, 0.01, true, true, false, ms, solvers[s], work,
+					Xs, f);
+				ElasticCurvesROStart(C2, nullptr, q1, C1s + d * ns, d, n, ns, 0.01, true, true, false, ms, solvers[s], work,
+					Xsc, fc, nullptr, nullptr, &cache);
+				err = std::max(err, fabs(f - fc));
+				err = std::max(err, CheckMaxDiff(Xs, Xsc, sizex));
+			}
+			double f, fc;
+			ElasticCurvesROStart(C2h, nullptr, q1h, C1sh + d * nsh, d, nh, nsh, 0.01, true, true, false, 0, solvers[s], work,
+				Xs, f);
+			ElasticCurvesROStart(C2h, nullptr, q1h, C1sh + d * nsh, d, nh, nsh, 0.01, true, true, false, 0, solvers[s], work,
+				Xsc, fc, nullptr, nullptr, &cache);
+			err = std::max(err, fabs(f - fc));
+			err = std::max(err, CheckMaxDiff(Xs, Xsc, nh + d * d + 1));
+			delete cache;
+		}
+		delete[] work;
+		delete[] C1sh;
+		delete[] C1s;
+		delete[] C1;
+	}
+	return err;
+};
+
+/*For open curves in R^3, the rotation O in opt must be the best rotation of q2 warped by the gamma in opt to q1, and
+the cost \|q1 - O (q2 o gamma) sqrt(gamma')\|^2 recomputed from opt must be fopts[0]. The largest error of the rotation
+is returned and the largest relative error of the cost is written to errcost. The solver stops on the relative
+decrease of the cost, which is flat in O near the minimum, so O is only accurate to about the square root of the
+tolerance. The warped q2 is interpolated linearly, so the relative error of the cost is of the order of the grid size.*/
+static double CheckRotation(int n, int numcurves, double &errcost)
+{
+	int d = 3, sizex = n + d * d + 1;
+	double err = 0;
+	errcost = 0;
+	double *C1 = new double[2 * d * n + 3 * d * n + sizex];
+	double *C2 = C1 + d * n, *q1 = C2 + d * n, *q2 = q1 + d * n, *q2g = q2 + d * n, *opt = q2g + d * n;
+	double fopts[5], comtime[5], Ob[9];
+	for (int k = 0; k < numcurves; k++)
+	{
+		BenchCurves(k + 1, d, n, false, C1, C2);
+		optimum_reparam(C1, C2, n, d, 0.0, false, true, false, 4, 0, opt, false, fopts, comtime);
+		CurveToQ(C1, d, n, q1, false);
+		CurveToQ(C2, d, n, q2, false);
+		for (integer i = 0; i < n; i++)
+		{
+			double g = opt[i] * (n - 1);
+			integer j = std::min(static_cast<integer> (g), static_cast<integer> (n - 2));
+			double r = g - j;
+			double dgam = (i == 0) ? opt[1] - opt[0] : ((i == n - 1) ? opt[n - 1] - opt[n - 2] : (opt[i + 1] - opt[i - 1]) / 2);
+			dgam = sqrt(fabs(dgam) * (n - 1));
+			for (integer t = 0; t < d; t++)
+				q2g[i + t * n] = ((1 - r) * q2[j + t * n] + r * q2[j + 1 + t * n]) * dgam;
+		}
+		FindBestRotation(q1, q2g, d, n, Ob);
+		err = std::max(err, CheckMaxDiff(opt + n, Ob, d * d));
+
+		double cost = 0;
+		for (integer i = 0; i < n; i++)
+		{
+			double wi = (i == 0 || i == n - 1) ? 0.5 : 1;
+			for (integer t = 0; t < d; t++)
+			{
+				double v = q1[i + t * n];
+				for (integer s = 0; s < d; s++)
+					v -= opt[n + t + s * d] * q2g[i + s * n];
+				cost += wi * v * v / (n - 1);
+			}
+		}
+		errcost = std::max(errcost, fabs(cost - fopts[0]) / fopts[0]);
+	}
+	delete[] C1;
+	return err;
+};
+
+/*optimum_reparam_warm started from its own optimum, for open and closed curves in R^2 and R^3. The refinement of an
+optimum still lowers its cost by up to about 30% (see warmtol of DriverElasticCurvesROOptions), so warmtol = 0.5 must
+take the warm start. Returns the largest relative increase of the cost, or 1 if the warm start was not taken.*/
+static double CheckWarm(int n)
+{
+	double err = 0;
+	for (int c = 0; c < 2; c++)
+	{
+		for (int d = 2; d <= 3; d++)
+		{
+			int sizex = n + d * d + 1, swap, warm;
+			double *C1 = new double[2 * d * n + sizex];
+			double *C2 = C1 + d * n, *opt = C2 + d * n;
+			double fopts[5], fopts1[5], comtime[5];
+			BenchCurves(1, d, n, (c == 1), C1, C2);
+			optimum_reparam_warm(C1, C2, n, d, 0.01, false, true, (c == 1), 4, 0, nullptr, 0, 0, opt, &swap, fopts, comtime,
+				&warm);
+			optimum_reparam_warm(C1, C2, n, d, 0.01, false, true, (c == 1), 4, 0, opt, swap, 0.5, opt, &swap, fopts1, comtime,
+				&warm);
+			err = std::max(err, (warm == 1) ? (fopts1[0] - fopts[0]) / fopts[0] : 1);
+			delete[] C1;
+		}
+	}
+	return err;
+};
+
+/*BestRotation2 and BestRotation3 against O = U diag(1, ..., 1, det(U V^T)) V^T from the singular value decomposition
+U S V^T = M, for random M. Both the rotations and the maxima trace(O^T M) are compared.*/
+static double CheckBestRotation(integer numtrials)
+{
+	RandGenContext ctx;
+	genrandseed(&ctx, 1);
+	char *joba = const_cast<char *> ("A");
+	double M[9], Mc[9], O[9], Oref[9], U[9], Vt[9], S[3], work[64];
+	integer lwork = 64, info;
+	double err = 0;
+	for (integer d = 2; d <= 3; d++)
+	{
+		for (integer k = 0; k < numtrials; k++)
+		{
+			for (integer i = 0; i < d * d; i++)
+				M[i] = genrandnormal(&ctx);
+			double fmax = (d == 2) ? BestRotation2(M, O) : BestRotation3(M, O);
+
+			integer len = d * d;
+			dcopy_(&len, M, &GLOBAL::IONE, Mc, &GLOBAL::IONE);
+			// SVD: U * S * Vt = M, details: http://www.netlib.org/lapack/explore-html/d8/d2d/dgesvd_8f.html
+			dgesvd_(joba, joba, &d, &d, Mc, &d, S, U, &d, Vt, &d, work, &lwork, &info);
+			// the sign of det(U V^T), from the products of U and Vt with their cofactors
+			double detU = (d == 2) ? U[0] * U[3] - U[1] * U[2] : U[0] * (U[4] * U[8] - U[5] * U[7])
+				- U[3] * (U[1] * U[8] - U[2] * U[7]) + U[6] * (U[1] * U[5] - U[2] * U[4]);
+			double detVt = (d == 2) ? Vt[0] * Vt[3] - Vt[1] * Vt[2] : Vt[0] * (Vt[4] * Vt[8] - Vt[5] * Vt[7])
+				- Vt[3] * (Vt[1] * Vt[8] - Vt[2] * Vt[7]) + Vt[6] * (Vt[1] * Vt[5] - Vt[2] * Vt[4]);
+			double sign = (detU * detVt > 0) ? 1 : -1;
+			double fref = 0;
+			for (integer i = 0; i < d; i++)
+			{
+				for (integer j = 0; j < d; j++)
+				{
+					Oref[i + j * d] = 0;
+					for (integer t = 0; t < d; t++)
+						Oref[i + j * d] += U[i + t * d] * ((t == d - 1) ? sign : 1) * Vt[t + j * d];
+					fref += Oref[i + j * d] * M[i + j * d];
+				}
+			}
+			err = std::max(err, CheckMaxDiff(O, Oref, d * d));
+			err = std::max(err, fabs(fmax - fref));
+		}
+	}
+	return err;
+};
+
+int main(void)
+{
+	integer failed = 0;
+	double errcost;
+	failed += CheckReport("batch", CheckBatch(60, 3), 0);
+	failed += CheckReport("manifold", CheckManifold(100, 3), 1e-6);
+	failed += CheckReport("reset", CheckReset(100), 0);
+	failed += CheckReport("rotation", CheckRotation(101, 4, errcost), 1e-1);
+	failed += CheckReport("cost", errcost, 1e-2);
+	failed += CheckReport("warm", CheckWarm(100), 1e-10);
+	failed += CheckReport("bestrot", CheckBestRotation(100), 1e-10);
+	printf("%ld of 7 checks failed\n", failed);
+	return static_cast<int> (failed);
+};
@@ -41,10 +41,15 @@ acceptable global optimum. The idea of computing initial points is given in [HGS
 #include "LRTRSR1.h"
 
 #include "ElasticCurvesRO.h"
+#include "ElasticCurvesManifold.h"
 #include "MyMatrix.h"
 
 #include "def.h"
 
+#ifdef ROPTLIB_WITH_FFTW
+#include "fftw3.h"
+#endif
+
 /*Define the namespace*/
 namespace ROPTLIB{
 
@@ -82,6 +87,44 @@ namespace ROPTLIB{
 	*/
 	enum SLOPESTYPE{ NUMBIG, NUMSMALL };
 
+	/*The options of DriverElasticCurvesRO beyond the problem and its outputs. The defaults refine all the break points
+	on the default number of OpenMP threads, without seeding by shift scores, telemetry, warm start or template cache.*/
+	struct DriverElasticCurvesROOptions{
+		/*the number of OpenMP threads the initial break points are split over. 0 uses the OpenMP default.*/
+		integer nthreads = 0;
+		/*if positive and a Riemannian method is used, every break point is first screened by the coarse Dynamic
+		Programming energy and only the numrefine best ones are refined by the solver. 0 refines all.*/
+		integer numrefine = 0;
+		/*if positive and the curves are closed, the break points are not taken from the turning angle of the curve but
+		are the (at most) numseeds best shifts given by ShiftRotationScores and FindSeedsByScores.*/
+		integer numseeds = 0;
+		/*if not nullptr, the solver times of all the refined starts are added to telemetry->times and the per-iteration
+		records of the start giving Xopt are appended to telemetry->records (see SolverTelemetry). Nothing is printed.*/
+		SolverTelemetry *telemetry = nullptr;
+		/*if not nullptr and a Riemannian method is used, the data of a previous Xopt (n + d * d + 1), e.g., of the
+		same curve aligned to the previous template in a Karcher mean iteration, whose swap was swapinit. It is refined
+		by the solver without Dynamic Programming (ElasticCurvesROWarmStart) and competes with the other starts.
+		It is ignored if the curves are not swapped as swapinit says.*/
+		const double *Xinit = nullptr;
+		bool swapinit = false;
+		/*if the cost of the refined Xinit is lower than the cost of Xinit by at most warmtol times the cost of
+		Xinit, i.e., Xinit is still nearly optimal, then it is taken as Xopt and the seeding by shift scores, the
+		Dynamic Programming and the other starts are skipped. In that case numinitialx is 0. A negative warmtol never skips.
+		The test only says that the solver did not move far from Xinit: a skipped call returns a local minimum near
+		Xinit, which may be worse than the result of a call without Xinit, e.g., if the curves changed such that
+		another break point or rotation is better. If the starts are not skipped, the refined Xinit competes with
+		them, and the result is not worse than without Xinit. The solver stops on the relative decrease of one
+		iteration, so refining a previous Xopt of the same curves still lowers its cost, by 0-7% for open and up to
+		31% for closed synthetic curves (BenchCurves.h, n = 100 to 400); warmtol must be of that order for the warm
+		start to be taken.*/
+		double warmtol = -1;
+		/*if not nullptr, C1 resampled on optns coarse points by GetCurveSmall followed by its q (2 * d * optns), e.g.,
+		of the template of a batch. It is used instead of computing them again if the curves are not swapped and the
+		driver uses ns = optns coarse points (see CoarseNumPoints).*/
+		const double *optC1s = nullptr;
+		integer optns = 0;
+	};
+
 	/*The entrance of the driver
 	C1, C2 are two curves in R^d. The curves are represented by n points.
 	w is the coefficient used in the barrier function.
@@ -89,10 +132,62 @@ namespace ROPTLIB{
 	isclosed: whether the curve is closed or not.
 	onlyDP: Dynamic Programming is used without using Riemannian optimization to improve the solution.
 	skipm: the interval between two break points is at least skipm.
+	options: the threads, screening, seeding, telemetry, warm start and template cache (see DriverElasticCurvesROOptions).
 	*/
 	void DriverElasticCurvesRO(double *C1, double *C2, integer d, integer n, double w, bool rotated, bool isclosed,
 		bool onlyDP, integer skipm, std::string solverstr, integer autoselectC, ProductElement *Xopt, bool &swap, double *fopts,
-		double *comtime, integer &Nsout, integer &numinitialx, double *optQ1 = nullptr, double *optQ2 = nullptr);
+		double *comtime, integer &Nsout, integer &numinitialx, double *optQ1 = nullptr, double *optQ2 = nullptr,
+		const DriverElasticCurvesROOptions &options = DriverElasticCurvesROOptions());
+
+	/*Shift C2 (and optQ2) by the break point ms, rotate it to q1 and compute the initial gamma by Dynamic
+	Programming: on the ns coarse points against q1s (NUMSMALL), or on the dense grid against q1 (NUMBIG) if onlyDP.
+	The results are left in work, laid out as in ElasticCurvesROStart. Returns the Dynamic Programming energy.
+	If keep is not nullptr and not onlyDP, the energy, the rotation O and the coarse gamma are written to keep
+	(1 + d * d + ns). If seed is not nullptr, it is keep of a previous call with the same ms, and the rotation and
+	the gamma are taken from it instead of computing them again.*/
+	double ElasticCurvesROSeed(const double *C2, const double *optQ2, const double *q1, const double *q1s, integer d, integer n,
+		integer ns, bool rotated, bool isclosed, bool onlyDP, integer ms, double *work, const double *seed = nullptr,
+		double *keep = nullptr);
+
+	/*Run one start of the driver from the break point ms: shift and rotate C2, compute the initial gamma
+	by Dynamic Programming and refine it by solverstr unless onlyDP. The candidate (gamma, rotation, shift)
+	is written to Xs (n + d * d + 1) and its cost to fopt. The manifold, problem and solver are local, or the solver
+	is given by cache, so starts can run concurrently with separate work arrays and caches of length
+	4 * d * n + n + 3 * d * d + (onlyDP ? 4 * d * (n - 1) + n * d : 2 * d * ns + ns).
+	The telemetry of the solver is collected in telemetry if it is not nullptr. If q2coefs is not nullptr and the curves
+	are closed, it is the periodic spline coefficients of q2 (see ElasticCurvesRO), which the problem shifts and rotates
+	instead of computing the splines of the shifted and rotated q2. cache is as in ElasticCurvesROSolve. If seed is not
+	nullptr, it is the seed of ms kept by ElasticCurvesROSeed, e.g., when the break points were screened, and the Dynamic
+	Programming is not done again. Returns false if solverstr is not a known solver.*/
+	bool ElasticCurvesROStart(const double *C2, const double *optQ2, double *q1, const double *q1s, integer d, integer n,
+		integer ns, double w, bool rotated, bool isclosed, bool onlyDP, integer ms, std::string solverstr, double *work,
+		double *Xs, double &fopt, SolverTelemetry *telemetry = nullptr, const double *q2coefs = nullptr, Solvers **cache = nullptr,
+		const double *seed = nullptr);
+
+	/*Run one start of the driver from a previous Xopt given in Xinit (n + d * d + 1) instead of a Dynamic Programming
+	seed: the shift of Xinit is split into a break point on the grid and the rest, C2 is shifted by the break point and
+	rotated by the rotation of Xinit, and the solver starts from the square root of the derivative of the gamma of Xinit,
+	the identity and the rest of the shift. work (4 * d * n + n + 3 * d * d), Xs, fopt and telemetry are as in
+	ElasticCurvesROStart. The cost of Xinit, without the barrier, is written to finit. q2coefs is as in ElasticCurvesROStart
+	and cache as in ElasticCurvesROSolve. Returns false if solverstr is not a known solver.*/
+	bool ElasticCurvesROWarmStart(const double *C2, const double *optQ2, double *q1, integer d, integer n, double w,
+		bool rotated, bool isclosed, std::string solverstr, const double *Xinit, double *work, double *Xs, double &fopt,
+		double &finit, SolverTelemetry *telemetry = nullptr, const double *q2coefs = nullptr, Solvers **cache = nullptr);
+
+	/*Refine the initial iterate InitialX on Domain by solverstr for q1 and the shifted and rotated Rotq2shift, where
+	O is the rotation and ms the break point applied to C2. Domain is given by NewElasticCurvesManifold and InitialX is
+	an ElasticCurvesVariable, or any manifold and variable with the same layout, e.g., the ProductManifold of L2Sphere,
+	OrthGroup and Euclidean. The result is turned into (gamma, rotation, shift) in Xs
+	and its cost, without the barrier, in fopt. If finit is not nullptr, the cost of InitialX is written to it.
+	O2 is d * d workspace. If q2coefs is not nullptr and the curves are closed, the problem is built from it as in
+	ElasticCurvesROStart, and Rotq2shift is not used. If cache is not nullptr, *cache is nullptr or the solver left by a
+	previous call with the same solverstr, d and n. That solver is reset (Solvers::Reset) and run instead of a new one, and
+	the solver used is left in *cache for the next call, which the caller deletes. Returns false if solverstr is not a
+	known solver.*/
+	bool ElasticCurvesROSolve(double *q1, double *Rotq2shift, const double *O, integer d, integer n, double w, bool rotated,
+		bool isclosed, integer ms, std::string solverstr, Manifold *Domain, Variable *InitialX, double *O2,
+		double *Xs, double &fopt, SolverTelemetry *telemetry, double *finit = nullptr, const double *q2coefs = nullptr,
+		Solvers **cache = nullptr);
 
 	/*The dynamic programming*/
 	double DynamicProgramming(const double *p_q1, const double *p_q2, integer d, integer N, double *gamma, bool isclosed, SLOPESTYPE Nbrstype);
@@ -106,6 +201,10 @@ namespace ROPTLIB{
 	/*Compute the total change of the angle along the curve C*/
 	double ComputeTotalAngle(const double *C, integer d, integer n);
 
+	/*The number of coarse points of the driver for a curve with total angle TAC. It is given by the total angle of C1
+	for closed curves and of C2 for open curves, after the swap.*/
+	integer CoarseNumPoints(integer n, double TAC);
+
 	/*Find the initial break points and the Ns for the coarse dynamic programming*/
 	void FindInitialBreaksAndNs(const double *C, integer d, integer n, integer minSkip, double thresholdsmall,
 		integer rand_shift, integer *p_ms, integer &Lms, integer &Ns);
@@ -122,6 +221,16 @@ namespace ROPTLIB{
 	/*Find the best rotation between q1 and q2, i.e., \min_O \|Oq1 - q2\|_{L^2}*/
 	void FindBestRotation(const double *q1, const double *q2, integer d, integer n, double *O);
 
+	/*The rotation O (2 x 2) maximizing trace(O^T M) in closed form, the maximum is returned. O can be nullptr.*/
+	double BestRotation2(const double *M, double *O);
+
+	/*The rotation O (3 x 3) maximizing trace(O^T M) from the unit quaternion of the largest eigenvalue of the 4 x 4
+	symmetric matrix given by M (Horn's method), computed by the Jacobi method. The maximum is returned. O can be nullptr.*/
+	double BestRotation3(const double *M, double *O);
+
+	/*result = C * O^T, i.e., rotate the curve C (n x d) by O (d x d). The loops are unrolled for d = 2, 3.*/
+	void RotateCurve(const double *C, const double *O, integer d, integer n, double *result);
+
 	/*Resample the curve using cubic spline interpolation and use ns points to represent the curve*/
 	void GetCurveSmall(const double *C, double *Cs, integer d, integer n, integer ns, bool isclosed);
 
@@ -137,6 +246,16 @@ namespace ROPTLIB{
 	/*Compute the gradient using finite difference (Center)*/
 	void GradientPeriod(const double *DPgam, integer n, double h, double *grad);
 
+	/*Score all n - 1 circular shifts m of the closed q2 against q1 at once:
+	E[m] = \|q1 - O_m q2(. + m)\|_{L^2}^2, where O_m is the best rotation (FindBestRotation) if rotated and the identity otherwise.
+	The d * d cross-correlations <q1_i, q2_j(. + m)> are computed for all m by FFT if ROPTLIB_WITH_FFTW is defined
+	(link with -lfftw3), and summed directly otherwise. For d = 2 the best rotation is in closed form.*/
+	void ShiftRotationScores(const double *q1, const double *q2, integer d, integer n, bool rotated, double *E);
+
+	/*Choose at most numseeds shifts among the local minima of the circular scores E (n - 1), lowest first,
+	and at least minSkip points apart. The shifts are stored in ms and their number in lms.*/
+	void FindSeedsByScores(const double *E, integer n, integer numseeds, integer minSkip, integer *ms, integer &lms);
+
 }; /*end of ROPTLIB namespace*/
 
 #endif // end of DRIVERELASTICCURVESRO_H
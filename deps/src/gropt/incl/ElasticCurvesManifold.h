@@ -0,0 +1,140 @@
+/*
+This file defines the class for the domain of the elastic curve registration problem, i.e., the product of the sphere in
+L^2([0, 1], R), the orthogonal group O_d and R. It is the same manifold as
+ProductManifold(3, L2Sphere(n), 1, OrthGroup(d), 1, Euclidean(1), 1) with the default parameters of the three manifolds,
+i.e., the trapezoidal metric, the exponential mapping and the parallel translation on the sphere, the qf retraction,
+the vector transport by parallelization and the intrinsic representation by the Householder reflections on O_d.
+The points and the tangent vectors are flat elements (ElasticCurvesVariable and ElasticCurvesVector) with the same layout
+as the ProductElement, and the three components are handled in one call without the product plumbing. Since x is
+square on O_d, the Householder reflections of the qr decomposition of x are x itself up to the signs, so the
+intrinsic representation is computed from x^T etax and the qf retraction by the modified Gram-Schmidt process,
+which are equal to the results of the Stiefel routines up to rounding errors.
+
+The class is templated on the dimension D of the curves such that the loops on O_d are unrolled for D = 1, 2, 3.
+D = 0 gives the dimension at runtime. NewElasticCurvesManifold chooses one of them.
+
+Manifold --> ElasticCurvesManifold
+*/
+
+#ifndef ELASTICCURVESMANIFOLD_H
+#define ELASTICCURVESMANIFOLD_H
+
+#include "Manifold.h"
+#include "ElasticCurvesVariable.h"
+#include "ElasticCurvesVector.h"
+#include "SharedSpace.h"
+#include "LinearOPE.h"
+#include "Problem.h"
+#include "def.h"
+
+/*Define the namespace*/
+namespace ROPTLIB{
+
+	template <integer D>
+	class ElasticCurvesManifold : public Manifold{
+	public:
+		/*Construct the manifold. inn uniformly-spaced points in [0, 1] are used to discretize the functions and ind is
+		the dimension of the curves, which must be D if D > 0.*/
+		ElasticCurvesManifold(integer inn, integer ind = D);
+
+		/*Delete EMPTYINTR and EMPTYEXTR*/
+		virtual ~ElasticCurvesManifold(void);
+
+		/*The sum of the trapezoidal rule on l and the Euclidean metric on the other components, one pass over etax and xix.
+		The representation is given by the length of etax.*/
+		virtual double Metric(Variable *x, Vector *etax, Vector *xix) const;
+
+		/*Call IntrProjection if IsIntrApproach is true and ExtrProjection otherwise.*/
+		virtual void Projection(Variable *x, Vector *v, Vector *result) const;
+
+		/*The exponential mapping on l, the qf retraction on O and the addition on m. etax uses the intrinsic representation
+		on O if IsIntrApproach is true and the extrinsic one otherwise.*/
+		virtual void Retraction(Variable *x, Vector *etax, Variable *result, double stepsize) const;
+
+		/*This is not done yet*/
+		virtual void coTangentVector(Variable *x, Vector *etax, Variable *y, Vector *xiy, Vector *result) const;
+
+		/*The parallel translation on l, which is only done if IsEtaXiSameDir is true as in L2Sphere, the differentiated
+		qf retraction on O and the identity on m. If IsEtaXiSameDir is true, then beta and betaTReta are attached to etax
+		as in ProductManifold.*/
+		virtual void DiffRetraction(Variable *x, Vector *etax, Variable *y, Vector *xix, Vector *result, bool IsEtaXiSameDir = false) const;
+
+		/*The parallel translation on l and the identity on the other components*/
+		virtual void VectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xix, Vector *result) const;
+
+		/*The inverse of the parallel translation on l and the identity on the other components*/
+		virtual void InverseVectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xiy, Vector *result) const;
+
+		/*result = Hx * T^{-1}, where T is VectorTransport. Only the columns start : start + n - 1, i.e., l, are changed.*/
+		virtual void HInvTran(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, integer start, integer end, LinearOPE *result) const;
+
+		/*result = T * Hx, where T is VectorTransport. Only the rows start : start + n - 1, i.e., l, are changed.*/
+		virtual void TranH(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, integer start, integer end, LinearOPE *result) const;
+
+		/*result = T * Hx * T^{-1}, where T is VectorTransport*/
+		virtual void TranHInvTran(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, LinearOPE *result) const;
+
+		/*result = Hx + scalar * etax * xix^{\flat}, where xix^{\flat} is given by ObtainEtaxFlat.*/
+		virtual void HaddScaledRank1OPE(Variable *x, LinearOPE *Hx, double scalar, Vector *etax, Vector *xix, LinearOPE *result) const;
+
+		/*The trapezoidal weights times etax on l and etax on the other components. etax and etaxflat can be a same argument.*/
+		virtual void ObtainEtaxFlat(Variable *x, Vector *etax, Vector *etaxflat) const;
+
+		/*The intrinsic representation on O is sqrt(2) times the strictly lower triangular part of the skew part of
+		x^T etax, l and m are copied.*/
+		virtual void ObtainIntr(Variable *x, Vector *etax, Vector *result) const;
+
+		/*The inverse of ObtainIntr*/
+		virtual void ObtainExtr(Variable *x, Vector *intretax, Vector *result) const;
+
+		/*The projection onto the tangent space on l, the other components are copied. v and result can be a same argument.*/
+		virtual void IntrProjection(Variable *x, Vector *v, Vector *result) const;
+
+		/*The projection onto the tangent space on l and O, m is copied. v and result can be a same argument.*/
+		virtual void ExtrProjection(Variable *x, Vector *v, Vector *result) const;
+
+		/*Check whether all the parameters are legal or not.*/
+		virtual void CheckParams(void) const;
+
+		/*gf = P_{T_x M} egf, egf and gf use the extrinsic representation.*/
+		virtual void EucGradToGrad(Variable *x, Vector *egf, Vector *gf, const Problem *prob) const;
+
+		/*The action of the Riemannian Hessian from the action of the Euclidean Hessian on each component,
+		as in L2Sphere and Stiefel.*/
+		virtual void EucHvToHv(Variable *x, Vector *etax, Vector *exix, Vector* xix, const Problem *prob) const;
+
+	private:
+		/*The dimension of the rotation, a constant if D > 0*/
+		inline integer Dim(void) const { return (D > 0) ? D : d; };
+
+		/*The trapezoidal rule of the inner product of a and b of length n*/
+		double TrapezoidDot(const double *a, const double *b) const;
+
+		/*result = z + scalar * g(u, v) * w on l, result may alias any of the inputs*/
+		void MetricAxpy(double scalar, const double *u, const double *v, const double *w, const double *z, double *result) const;
+
+		/*Attach (x + y) / \|x + y\|^2 of the l components to etax, which is used by the parallel translation*/
+		void ObtainXdydn2(Variable *x, Vector *etax, Variable *y) const;
+
+		/*w = the intrinsic representation of E (d x d) at O*/
+		void RotIntr(const double *O, const double *E, double *w) const;
+
+		/*E = O * Omega, where Omega is the skew matrix given by the intrinsic representation w*/
+		void RotExtr(const double *O, const double *w, double *E) const;
+
+		/*R = V - O sym(O^T V), R may alias V. S is d x d workspace.*/
+		void RotProjection(const double *O, const double *V, double *R, double *S) const;
+
+		/*Replace X by the orthonormal factor of its qr decomposition with the positive diagonal of R*/
+		void RotQf(double *X) const;
+
+		integer n; /*The number of points of l*/
+		integer d; /*The dimension of the rotation*/
+		integer slotxdydn2; /*The temp data slot of (x + y) / \|x + y\|^2*/
+	};
+
+	/*Create the manifold for the dimension d of the curves, i.e., ElasticCurvesManifold<d> if d <= 3 and
+	ElasticCurvesManifold<0> otherwise. The caller deletes it.*/
+	Manifold *NewElasticCurvesManifold(integer n, integer d);
+}; /*end of ROPTLIB namespace*/
+#endif // end of ELASTICCURVESMANIFOLD_H
@@ -31,6 +31,7 @@ Problem --> ElasticCurvesRO
 #include "def.h"
 #include "Problem.h"
 #include "SharedSpace.h"
+#include "MemoryPool.h"
 #include "Spline.h"
 
 /*Define the namespace*/
@@ -43,6 +44,14 @@ namespace ROPTLIB{
 		If isclosed is true, then make sure the first and last points of C1 and C2 must be the same.*/
 		ElasticCurvesRO(double *inq1, double *inq2, integer ind, integer inn, double inw, bool inrotated, bool inisclosed);
 
+		/* The problem for closed curves where q2 is C2 shifted by the break point inms (see ShiftC) and rotated by inO,
+		i.e., q2 * inO^T, given by the periodic spline coefficients inq2coefs of the unshifted q2 (Spline::SplineUniformPeriodic
+		per dimension, 4 (n - 1) coefficients each). The periodic spline of the shifted data is the circular shift of the
+		intervals and the spline is linear in the data, so no spline is solved and the coefficients can be shared by all
+		break points. inO is d by d, nullptr means the identity.*/
+		ElasticCurvesRO(double *inq1, const double *inq2coefs, integer inms, const double *inO, integer ind, integer inn,
+			double inw, bool inrotated);
+
 		/*Destructor*/
 		virtual ~ElasticCurvesRO();
 
@@ -55,6 +64,12 @@ namespace ROPTLIB{
 		/*Euclidean gradient*/
 		virtual void EucGrad(Variable *x, Vector *egf) const;
 
+		/*Cost function and Riemannian gradient in one pass over the n samples*/
+		virtual double FuncGrad(Variable *x, Vector *gf) const;
+
+		/*FuncGrad shares the evaluation of q2 \circ gamma, so it is cheaper than f and Grad*/
+		virtual bool HasFuncGrad(void) const;
+
 		/*Action of the Euclidean Hessian, i.e., exix = EucHess f(x)[etax]*/
 		virtual void EucHessianEta(Variable *x, Vector *etax, Vector *exix) const;
 
@@ -77,15 +92,32 @@ namespace ROPTLIB{
 
 		mutable double w;			/* coefficient of penlty term*/
 	private:
+		/* Evaluate the cost function and attach gamma, q2 \circ gamma, O q1 and O q1 - q2 \circ gamma l to x.
+		If egf is not nullptr, the Euclidean gradient is computed in the same pass over the samples. */
+		double FuncEucGrad(Variable *x, Vector *egf) const;
+
+		/* The part of the Euclidean gradient that does not loop over the dimensions at each sample:
+		yy is the cumulative integral of dyy, dl and dO are the gradients with respect to l and O. */
+		void EucGradFromSamples(const double *l, const double *q2g, const double *xx, const double *dyy,
+			double *yy, double *dl, double *dO) const;
+
+		/* Set the parameters, register the temp slots and allocate q2_coefs, dq2_coefs and ddq2_coefs */
+		void Initialization(double *inq1, integer ind, integer inn, double inw, bool inrotated, bool inisclosed);
+
+		/* Compute the derivatives of the spline coefficients coefs (4 (n - 1) per dimension, followed by the space of the
+		derivatives) and interleave all of them into q2_coefs, dq2_coefs and ddq2_coefs */
+		void SetCoefs(double *coefs);
 
 		double *q1;			/* q1 is represented by n by d matrices*/
-		double *q2_coefs;	/* q2 is represented by cubic splines, which represented by (n - 1) by 4 d matrices */
-		double *dq2_coefs;	/* The first derivative of the cubic splines, i.e., (n - 1) by 3 d matrices */
-		double *ddq2_coefs;	/* The second derivative of the cubic splines, i.e., (n - 1) by 2 d matrices */
+		double *q2_coefs;	/* q2 is represented by cubic splines, 4 d coefficients per interval, see Spline::InterleaveUniform */
+		double *dq2_coefs;	/* The first derivative of the cubic splines, 3 d coefficients per interval */
+		double *ddq2_coefs;	/* The second derivative of the cubic splines, 2 d coefficients per interval */
 		mutable integer n;	/* the number of points for representing a function/curve */
 		mutable integer d;	/* the dimension of the curves lie */
 		bool rotated;		/* involve rotation or not */
 		bool isclosed;		/* for closed curves or open curves*/
+		/* slot ids of the temp data attached to x, see Element::RegisterTempSlot */
+		integer slotw, slotq2g, slotgam, slotOq1mq2l, slotOq1, slotdq2g, slotyy, slotddq2g;
 	};
 
 }; /*end of ROPTLIB namespace*/
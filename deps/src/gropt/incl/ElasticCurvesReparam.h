@@ -11,4 +11,43 @@ void optimum_reparam(double *C1, double *C2, int n, int d, double w,
                      int autoselectC, double *opt, bool swap, double *fopts,
                      double *comtime);
 
+/* Align K curves to one template, or K pairs of curves, on OpenMP threads.
+ * C1 is the template (n x d), or K templates (n x d x K) if pairs is true. C2 holds the K curves (n x d x K).
+ * The template-side square root velocity function and its coarse versions are computed once when pairs is false.
+ * The results of the k-th curve are written in column k of opt ((n + d*d + 1) x K), fopts (5 x K) and
+ * comtime (5 x K), and swap[k] is 1 if the two curves of the k-th pair have been swapped.
+ * nthreads <= 0 uses the default number of OpenMP threads. */
+extern "C" void optimum_reparam_batch(double *C1, double *C2, int n, int d, int K, bool pairs, double w,
+                     bool onlyDP, bool rotated, bool isclosed, int skipm,
+                     int autoselectC, int nthreads, double *opt, int *swap, double *fopts,
+                     double *comtime);
+
+/* optimum_reparam that also returns the telemetry of the solver, without printing anything.
+ * optimes (6 x 1) receives the wall time in seconds spent in the cost function, the gradient, the cost
+ * function and gradient evaluated together, the retraction, the vector transport and the line search,
+ * summed over all the starts (see SolverTelemetry in Solvers.h).
+ * records (9 x capacity) receives the per-iteration records of the start that gives opt, one column
+ * per iterate: iteration, time, cost, norm of gradient, step size, and the numbers of cost, gradient,
+ * retraction and vector transport evaluations. The number of records written is stored in length.
+ * records may be null if capacity is 0. */
+extern "C" void optimum_reparam_telemetry(double *C1, double *C2, int n, int d, double w,
+                     bool onlyDP, bool rotated, bool isclosed, int skipm,
+                     int autoselectC, double *opt, int *swap, double *fopts,
+                     double *comtime, double *optimes, double *records, int capacity, int *length);
+
+/* optimum_reparam warm started from a previous result, e.g., when the same curve is aligned again to the
+ * updated template of a Karcher mean iteration. optinit ((n + d*d + 1) x 1) is the opt of the previous call and
+ * swapinit its swap; optinit may be null, and may be the same array as opt. The previous gamma, rotation and shift
+ * are refined by the solver without Dynamic Programming. If the cost decreases by at most warmtol times the cost of
+ * optinit, the Dynamic Programming seeds and the multiple starts are skipped and warm is set to 1; otherwise the
+ * refined warm start competes with the usual starts and warm is set to 0. A negative warmtol never skips.
+ * With warm = 1, opt is a local minimum near optinit and may be worse than the result of optimum_reparam;
+ * with warm = 0 it is not. See warmtol of DriverElasticCurvesROOptions for the values of warmtol that take the warm
+ * start.
+ * The warm start is not used with onlyDP, or if the curves are swapped differently from swapinit. */
+extern "C" void optimum_reparam_warm(double *C1, double *C2, int n, int d, double w,
+                     bool onlyDP, bool rotated, bool isclosed, int skipm,
+                     int autoselectC, double *optinit, int swapinit, double warmtol,
+                     double *opt, int *swap, double *fopts, double *comtime, int *warm);
+
 #endif // end of TESTELASTICCURVESRO_H
@@ -0,0 +1,37 @@
+/*
+This file defines the class of a point on the domain of the elastic curve registration problem, i.e., the product
+of the sphere in L^2([0, 1], R), the orthogonal group O_d and R. The three components are stored contiguously
+in one array: ( l (n), O (d x d, column major), m (1) ), which is the same layout as the ProductElement of
+L2SphereVariable, OrthGroupVariable and EucVariable.
+
+SmartSpace --> Element --> ElasticCurvesVariable
+*/
+
+#ifndef ELASTICCURVESVARIABLE_H
+#define ELASTICCURVESVARIABLE_H
+
+#include "Element.h"
+#include <new>
+#include <iostream>
+#include "def.h"
+
+/*Define the namespace*/
+namespace ROPTLIB{
+
+	class ElasticCurvesVariable : public Element{
+	public:
+		/*Construct an empty variable with only size information. n denotes the number of points to represent
+		the continuous function and d the dimension of the curves.*/
+		ElasticCurvesVariable(integer n, integer d);
+
+		/*Create an object of ElasticCurvesVariable with same size as this ElasticCurvesVariable.*/
+		virtual ElasticCurvesVariable *ConstructEmpty(void) const;
+
+		/*This function randomly generates a point on the manifold.*/
+		virtual void RandInManifold();
+	private:
+		integer n; /*The number of points of l*/
+		integer d; /*The dimension of the rotation*/
+	};
+}; /*end of ROPTLIB namespace*/
+#endif // end of ELASTICCURVESVARIABLE_H
@@ -0,0 +1,29 @@
+/*
+This file defines the class of a tangent vector of the domain of the elastic curve registration problem, see
+ElasticCurvesVariable. The components are stored contiguously, i.e., ( l (n), O (d x d or d (d - 1) / 2), m (1) ).
+
+SmartSpace --> Element --> ElasticCurvesVector
+*/
+
+#ifndef ELASTICCURVESVECTOR_H
+#define ELASTICCURVESVECTOR_H
+
+#include "Element.h"
+#include <new>
+#include <iostream>
+#include "def.h"
+
+/*Define the namespace*/
+namespace ROPTLIB{
+
+	class ElasticCurvesVector : public Element{
+	public:
+		/*Construct an empty vector with only size information. length is n + d * d + 1 for the extrinsic
+		representation and n + d * (d - 1) / 2 + 1 for the intrinsic one.*/
+		ElasticCurvesVector(integer length);
+
+		/*Create an object of ElasticCurvesVector with same size as this ElasticCurvesVector.*/
+		virtual ElasticCurvesVector *ConstructEmpty(void) const;
+	};
+}; /*end of ROPTLIB namespace*/
+#endif // end of ELASTICCURVESVECTOR_H
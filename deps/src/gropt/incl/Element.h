@@ -29,8 +29,14 @@ namespace ROPTLIB{
 	/*Defined the type MAP*/
 	typedef std::map<std::string, SharedSpace *> MAP;
 
+	/*The number of temp data slots that can be registered by RegisterTempSlot*/
+#define NUMTEMPSLOTS 16
+
 	class Element : public SmartSpace{
 	public:
+		/*Start with no temp data in the slots.*/
+		Element();
+
 		/*Beside calling delete function in based class, it also removed all the tempory data.*/
 		virtual ~Element();
 
@@ -49,12 +55,12 @@ namespace ROPTLIB{
 		/*Randomly create this Element. In other words, the space will be allocated based
 		on the size. Then each entry in the space will be generated by the uniform distribution in [start, end].
 		Note that all the temporary data are also removed.*/
-		virtual void RandUnform(double start = 0, double end = 1);
+		virtual void RandUnform(double start = 0, double end = 1, RandGenContext *ctx = nullptr);
 
 		/*Randomly create this Element. In other words, the space will be allocated based
 		on the size. Then each entry in the space will be generated by the normal distribution with mean and variance.
 		Note that all the temporary data are also removed*/
-		virtual void RandGaussian(double mean = 0, double variance = 1);
+		virtual void RandGaussian(double mean = 0, double variance = 1, RandGenContext *ctx = nullptr);
 
 		/*Print the data. The string "name" is to mark the output such that user can find the output easily.
 		If isonlymain is true, then only output the data without outputing temporary data. Otherwise,
@@ -107,10 +113,42 @@ namespace ROPTLIB{
 		void ObtainTempNames(std::string *names) const;
 
 		/*Obtain the number of temp data*/
-		inline integer GetSizeofTempData() const { return static_cast<integer> (TempData.size()); };
+		inline integer GetSizeofTempData() const { return static_cast<integer> (TempData.size()) + NumTempSlotData; };
+
+		/*Register a temp data name and return its slot id. The same name always gives the same id, so a problem
+		registers its names once, e.g., in its constructor, and passes the ids to the functions below in f, EucGrad, etc.
+		They index a small array in the Element instead of searching the map of names.
+		Temp data added by slot id are not found by name and vice versa.
+		If all NUMTEMPSLOTS slots have been registered, print an error and exit, since the id would index past the slots.*/
+		static integer RegisterTempSlot(std::string name);
+
+		/*Obtain the name of a registered slot id*/
+		static std::string GetTempSlotName(integer id);
+
+		/*Add an object of SharedSpace type to this Element in the slot id.*/
+		virtual void AddToTempData(integer id, SharedSpace * &Temp);
+
+		/*Obtain the temp data in the slot id. It is NOT allowed to modify the temp data.*/
+		virtual const SharedSpace *ObtainReadTempData(integer id) const;
+
+		/*Obtain the temp data in the slot id. It is allowed to modify the temp data.*/
+		virtual SharedSpace *ObtainWriteTempData(integer id);
+
+		/*Remove the temp data in the slot id from this Element. */
+		virtual void RemoveFromTempData(integer id);
+
+		/*Check whether the slot id holds a temp data or not*/
+		inline bool TempDataExist(integer id) const { return TempSlots[id] != nullptr; };
 	protected:
+		/*Print the temp data, both named and in slots*/
+		void PrintTempData(const char *name) const;
+
 		/*The mapping which store the information of temp data*/
 		MAP TempData;
+
+		/*Temp data indexed by registered slot ids, and the number of them that are not empty*/
+		SharedSpace *TempSlots[NUMTEMPSLOTS];
+		integer NumTempSlotData;
 	};
 }; /*end of ROPTLIB namespace*/
 
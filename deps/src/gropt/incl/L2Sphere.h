@@ -39,13 +39,15 @@ namespace ROPTLIB{
 		/*Delete EMPTYINTR and EMPTYEXTR*/
 		virtual ~L2Sphere();
 
-		/*The composite trapezoidal rule is used to define the Riemannian metric.*/
+		/*The composite trapezoidal rule is used to define the Riemannian metric. It is one pass over etax and xix.*/
 		virtual double Metric(Variable *x, Vector *etax, Vector *xix) const;
 
-		/*etax is in the ambient space. This function projects etax onto the tangent space of x, i.e., result = P_{T_x M} v*/
+		/*etax is in the ambient space. This function projects etax onto the tangent space of x, i.e., result = P_{T_x M} v.
+		The metric and the update are fused, see MetricAxpy.*/
 		virtual void Projection(Variable *x, Vector *v, Vector *result) const;
 
-		/*Exponential mapping is used*/
+		/*Exponential mapping is used. The metrics of x and etax are computed in one pass and the normalized result is
+		written in a second one, i.e., the norm of the result is obtained from the metrics instead of another pass.*/
 		virtual void Retraction(Variable *x, Vector *etax, Variable *result, double stepsize) const;
 
 		/*This is not done yet*/
@@ -57,10 +59,10 @@ namespace ROPTLIB{
 		/*Return 1; This manifold uses exponential mapping and parallel translation. Therefore, using beta = 1 satisfies the locking condition.*/
 		virtual double Beta(Variable *x, Vector *etax) const;
 
-		/*Parallel translation*/
+		/*Parallel translation. The metric and the update are fused, see MetricAxpy.*/
 		virtual void VectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xix, Vector *result) const;
 
-		/*Inverse parallel translation*/
+		/*Inverse parallel translation. The metric and the update are fused, see MetricAxpy.*/
 		virtual void InverseVectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xiy, Vector *result) const;
 
 		/*Compute result = H(:, start : end) * \mathcal{T}^{-1}, where H(:, start : end) denotes the matrix formed by columns from "start" to "end".
@@ -74,7 +76,7 @@ namespace ROPTLIB{
 		/*Compute result = \mathcal{T} * H * \mathcal{T}^{-1}. \mathcal{T} is the parallel translation*/
 		virtual void TranHInvTran(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, LinearOPE *result) const;
 
-		/*Compute etaxflat = etax^{\flat}. */
+		/*Compute etaxflat = etax^{\flat} in one pass. */
 		virtual void ObtainEtaxFlat(Variable *x, Vector *etax, Vector *etaxflat) const;
 
 		/*This is not done yet*/
@@ -99,6 +101,17 @@ namespace ROPTLIB{
 		/*The Riemannian action of the Hessian is obtained by Hess f(x)[etax] = P_x(D grad f(x) [etax]).*/
 		virtual void EucHvToHv(Variable *x, Vector *etax, Vector *exix, Vector* xix, const Problem *prob) const;
 	private:
+		/*Return the trapezoidal rule of a b, i.e., the metric of a and b, by one pass (ddot).*/
+		double TrapezoidDot(const double *a, const double *b) const;
+
+		/*result = z + scalar * g(u, v) * w, where g is the metric, by one pass over u and v and one pass over w and z.
+		result may be any of u, v, w and z.*/
+		void MetricAxpy(double scalar, const double *u, const double *v, const double *w, const double *z, double *result) const;
+
+		/*Compute the vector (x + y) / \|x + y\|^2 used by the parallel translation and attach it to etax as "xdydn2"
+		if it is not there.*/
+		void ObtainXdydn2(Variable *x, Vector *etax, Variable *y) const;
+
 		mutable integer n; /*The number of points to represent the continuous function*/
 
 		Repa2NSMetric metric; /*Riemannian metric*/
@@ -27,15 +27,19 @@ namespace ROPTLIB{
 		insoln is the true solution. It is not required and only used for research*/
 		LRBFGS(const Problem *prob, const Variable *initialx, const Variable *insoln = nullptr);
 
-		/*Destructor. Delete the arrays and vectors used in LRBFGS, i.e., series S and Y, and series RHO*/
+		/*Destructor. Delete the arrays and vectors used in LRBFGS, i.e., series S and Y, series RHO and SYmat*/
 		virtual ~LRBFGS();
 
 		/*Check whether the parameters about LRBFGS are legal or not.*/
 		virtual void CheckParams();
 
-		/*Run the algorithm. New memory for S, Y and RHO. Then call SolversLS::Run*/
+		/*Run the algorithm. New memory for S, Y and RHO, and SYmat if CompactForm, unless the memory of the previous
+		run has the same size. Then call SolversLS::Run*/
 		virtual void Run();
 
+		/*Call SolversLS::Reset and forget the pairs of s and y of the previous run*/
+		virtual bool Reset(const Problem *prob, const Variable *initialx);
+
 		/*Call Solvers::SetProbX function and set up the temporary objects for LRBFGS algorithm.
 		INPUT:	prob is the problem which defines the cost function, gradient and possible the action of Hessian
 		and specifies the manifold of domain.
@@ -61,6 +65,8 @@ namespace ROPTLIB{
 		/*Print information specific to LRBFGS*/
 		virtual void PrintInfo();
 
+		integer LengthSYAllocated; /*The length of S, Y and RHO, which may differ from LengthSY if it is changed after a run*/
+
 	};
 }; /*end of ROPTLIB namespace*/
 #endif // end of RBROYDENFAMILY_H
@@ -37,6 +37,9 @@ namespace ROPTLIB{
 			matrices PMGQ, SS, and YY, and permutation indices P (see below for details of the series). Then call SolversTR::Run*/
 		virtual void Run();
 
+		/*Call SolversTR::Reset and forget the pairs of s and y of the previous run*/
+		virtual bool Reset(const Problem *prob, const Variable *initialx);
+
 		/*Computes the solution to a trust-region subproblem when the quadratic model is defined by
 		limited-memory symmetric rank-one (L-SR1) quasi-Newton matrix. The details can be found in [JJR17]
 		[JJR17]: On solving L-SR1 trust-region subproblems */
@@ -102,8 +102,9 @@ namespace ROPTLIB{
 		virtual void Projection(Variable *x, Vector *etax, Vector *result) const;
 
 		/*Randomly generate N vectors in the tangent space of x. The resulting vectors are stored in result_arr.
+		The numbers are drawn from ctx, or from the default context of the calling thread if ctx is nullptr.
 		This is used for the gradient sampling method, which is not supported yet.*/
-		virtual void RandomTangentVectors(Variable *x, integer N, Vector **result_arr) const;
+		virtual void RandomTangentVectors(Variable *x, integer N, Vector **result_arr, RandGenContext *ctx = nullptr) const;
 
 		/*Compute the retraction result = R_x(etax). A stepsize is also input for information.
 		Default: result = x + etax, Note it is NOT result = x + instepsize * etax; The instepsize
@@ -0,0 +1,75 @@
+/*
+This file defines a pool for the data buffers of SmartSpace and their reference counters.
+A solver evaluates the cost function, gradient and line search trial points thousands of
+times and each evaluation allocates and frees buffers of the same few lengths. When the pool
+is enabled, a freed buffer is kept in a per-thread free list for its length and is handed
+out again by the next request of that length instead of going through the heap.
+
+The pool is enabled by default and can be switched on and off at any time. Buffers always
+come from new[], so a buffer allocated with the pool disabled may be returned to the pool
+and vice versa. A thread keeps at most POOLMAXBYTES bytes of free buffers, the rest is freed.
+Threads that are kept alive by OpenMP keep their free lists until they call Release.
+
+MemoryPool
+*/
+
+#ifndef MEMORYPOOL_H
+#define MEMORYPOOL_H
+
+#include "def.h"
+
+/*Define the namespace*/
+namespace ROPTLIB{
+
+	/*The maximum number of free buffers kept for one length in one thread*/
+#define POOLMAXFREE 64
+
+	/*Buffers longer than this are never cached*/
+#define POOLMAXLENGTH 65536
+
+	/*The maximum number of bytes of free buffers kept in one thread*/
+#define POOLMAXBYTES (16 * 1024 * 1024)
+
+	/*Counters of the pool, summed over all threads*/
+	struct MemoryPoolCounters{
+		integer NumNew; /*buffers requested by NewDoubles*/
+		integer NumReused; /*requests served from a free list*/
+		integer NumDelete; /*buffers given back by DeleteDoubles*/
+		integer NumCached; /*buffers given back that were kept in a free list*/
+		integer NumNewCounter; /*reference counters requested by NewCounter*/
+		integer NumReusedCounter; /*reference counter requests served from a free list*/
+		integer NumDeleteCounter; /*reference counters given back by DeleteCounter*/
+		integer NumCachedCounter; /*reference counters given back that were kept in a free list*/
+		integer NumReleased; /*cached buffers and reference counters freed by Release*/
+	};
+
+	class MemoryPool{
+	public:
+		/*Enable or disable the pool. Disabling it does not free the cached buffers, see Release.*/
+		static void SetEnabled(bool enabled);
+
+		/*Whether the pool is enabled*/
+		static bool IsEnabled(void);
+
+		/*Obtain a buffer of length doubles. The content is not initialized.*/
+		static double *NewDoubles(integer length);
+
+		/*Give back a buffer of length doubles obtained by NewDoubles or new double[length].*/
+		static void DeleteDoubles(double *ptr, integer length);
+
+		/*Obtain a reference counter. Its value is not initialized.*/
+		static integer *NewCounter(void);
+
+		/*Give back a reference counter obtained by NewCounter or new integer.*/
+		static void DeleteCounter(integer *ptr);
+
+		/*Free the buffers and reference counters cached by the calling thread.*/
+		static void Release(void);
+
+		/*Obtain and reset the counters.*/
+		static MemoryPoolCounters GetCounters(void);
+		static void ResetCounters(void);
+	};
+}; /*end of ROPTLIB namespace*/
+
+#endif // end of MEMORYPOOL_H
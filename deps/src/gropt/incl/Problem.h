@@ -67,6 +67,15 @@ namespace ROPTLIB{
 		is illegal. */
 		virtual void EucHessianEta(Variable *x, Vector *etax, Vector *exix) const;
 
+		/*Evaluate the cost function and the gradient at iterate x together, i.e., return f(x) and set gf = Grad f(x).
+		The default calls "f" and then "Grad". A problem that shares work between the two overrides this function
+		and "HasFuncGrad".*/
+		virtual double FuncGrad(Variable *x, Vector *gf) const;
+
+		/*Whether "FuncGrad" is cheaper than calling "f" and "Grad". If it is, the line search solvers evaluate the gradient
+		together with the cost function at the first trial point, which is accepted in most of the iterations.*/
+		virtual bool HasFuncGrad(void) const;
+
 		/*The preconditioner in the Trust-region method.*/
 		virtual void PreConditioner(Variable *x, Vector *eta, Vector *result) const;
 
@@ -71,12 +71,12 @@ namespace ROPTLIB{
 		/*Randomly create this ProductElement. In other words, the space will be allocated based
 		on the size. Then each entry in the space will be generated by the uniform distribution in [start, end].
 		Note that all the temporary data are also removed.*/
-		virtual void RandUnform(double start = 0, double end = 1);
+		virtual void RandUnform(double start = 0, double end = 1, RandGenContext *ctx = nullptr);
 
 		/*Randomly create this Element. In other words, the space will be allocated based
 		on the size. Then each entry in the space will be generated by the normal distribution with mean and variance.
 		Note that all the temporary data are also removed*/
-		virtual void RandGaussian(double mean = 0, double variance = 1);
+		virtual void RandGaussian(double mean = 0, double variance = 1, RandGenContext *ctx = nullptr);
 
 		/*Print the data. The string "name" is to mark the output such that user can find the output easily.
 		If isonlymain is true, then only output the data without outputing temporary data. Otherwise,
@@ -98,6 +98,10 @@ namespace ROPTLIB{
 		Note that all the temporary data are also removed. */
 		virtual double *ObtainWritePartialData();
 
+		/*Remove the temporary data of this ProductElement and of its elements. The elements cache data computed from their
+		own part of the data, e.g., "xdydn2" of L2Sphere, which is no longer valid once the data are written.*/
+		virtual void RemoveAllFromTempData();
+
 		/*If the data is shared with other SmartSpace, then new memory are allocated without copying the data to the new memory.*/
 		virtual void NewMemoryOnWrite();
 
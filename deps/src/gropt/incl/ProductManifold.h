@@ -101,8 +101,9 @@ namespace ROPTLIB{
 		virtual void Projection(Variable *x, Vector *v, Vector *result) const;
 
 		/*Randomly generate N vectors in the tangent space of x. The resulting vectors are stored in result_arr.
+		The numbers are drawn from ctx, or from the default context of the calling thread if ctx is nullptr.
 		This is used for the gradient sampling method, which is not supported yet.*/
-		virtual void RandomTangentVectors(Variable *x, integer N, Vector **result_arr) const;
+		virtual void RandomTangentVectors(Variable *x, integer N, Vector **result_arr, RandGenContext *ctx = nullptr) const;
 
 		/*Compute the retraction result = R_x(etax). A stepsize is also input for information.
 		Default: Let x = (x_1, dots, x_n), etax=(etax_1, dots, etax_n), result = (r_1, dots, r_n).
@@ -174,6 +175,11 @@ namespace ROPTLIB{
 		Default: compute xix^{\flat} = (xix_1^\flat, cdots, xix_n^\flat) first, then compute esult = Hx + scalar * etax * xix^{\flat}*/
 		virtual void HaddScaledRank1OPE(Variable *x, LinearOPE *Hx, double scalar, Vector *etax, Vector *xix, LinearOPE *result) const;
 
+		/*Compute etaxflat = etax^{\flat}, i.e., etaxflat_i = etax_i^{\flat} by the i-th manifold for all i, so that
+		Metric(x, etax, xix) is the Euclidean inner product of etaxflat and xix.
+		etax and etaxflat can be a same argument.*/
+		virtual void ObtainEtaxFlat(Variable *x, Vector *etax, Vector *etaxflat) const;
+
 		/*etax is in the ambient space. This function projects etax onto the tangent space of x, i.e., result = P_{T_x M} etax;
 		For this function, the components of v and result are represented by extrinsic representations.
 		etax and result can be a same argument, i.e.,
@@ -253,6 +259,9 @@ namespace ROPTLIB{
 		integer numofmani; /*The number of kinds of manifolds, i.e., the length of manifolds*/
 		integer *powsinterval; /*Each manifold are located in what interval*/
 		integer numoftotalmani; /*The number of all manifolds.*/
+#ifdef TESTELASTICCURVESRO
+		integer slotw; /*The temp data slot of w of ElasticCurvesRO, which Retraction scales*/
+#endif
 
 		/*An example for store St(2, 3) ^ 2 \times Euc(2) is given below:
 		(Not exactly C++ code. just give an idea)
@@ -49,6 +49,25 @@ namespace ROPTLIB{
 		Default: 4*/
 		integer LengthSY;
 
+		/*If it is true, then LRBFGS keeps every pair of s and y at the iterate where it is computed instead of transporting
+		all the stored pairs to each new iterate. The two-loop recursion uses the pairs as they are stored and its result
+		is projected onto the tangent space at the current iterate, which is still a descent direction. This reduces the
+		vector transport work of an iteration from O(LengthSY n) to O(n), so that a larger LengthSY is affordable.
+		Only meaningful if the manifold uses the extrinsic representation or a parallelization-based intrinsic one.
+		Default: false*/
+		bool TransportFree;
+
+		/*If it is true, then LRBFGS keeps S and Y as the columns of one contiguous matrix and computes H v by the compact
+		representation of the limited-memory BFGS update [BNS1994, (3.1)], i.e., two matrix-vector products (dgemv) and
+		small triangular solves instead of 4 * LengthSY metric and axpy sweeps. The metrics between the stored vectors are
+		updated once per iteration by one more dgemv. It requires that the metric is the Euclidean inner product with
+		the flat of a tangent vector (Manifold::ObtainEtaxFlat), as for L2Sphere, Euclidean and their products, that the
+		vector transport is isometric, and that the problem has no preconditioner.
+		[BNS1994]: R. H. Byrd, J. Nocedal and R. B. Schnabel. Representations of quasi-Newton matrices and their use in
+		limited memory methods. Mathematical Programming, 63(1):129-156, 1994.
+		Default: false*/
+		bool CompactForm;
+
 		/*the number of previous bb1 stepsize. Used in ABB_min stepsize. See details in [SRTZ2017]
 		[SRTZ2017]: On the steplength selection in gradient methods for unconstrained optimization.
 		stepsize * id can be used as the initial Hessian approximation in limite-memory quasi-Newton methods
@@ -131,6 +150,18 @@ namespace ROPTLIB{
 		/*===================LRBFGS====================*/
 		/*initial Hessian approximation in limited-memory BFGS method. It is a scalar times identity.*/
 		virtual double InitialHessian(double inpss, double inpsy, double inpyy);
+
+		/*Compute result = H v in LRBFGS by the compact representation, see CompactForm*/
+		virtual void HvLRBFGSCompact(Vector *v, Vector *result);
+
+		/*Copy the stored pairs into SYmat and compute the metrics of all the stored s and y with the new y at slot idx,
+		see CompactForm. If all is true, every stored pair is copied, otherwise only the new one.
+		idx < 0 means that there is no new pair, e.g., only the transported pairs are copied.*/
+		virtual void UpdateCompactLRBFGS(integer idx, bool all);
+
+		double *SYmat; /*CompactForm: S and Y as the columns of a length x (2 LengthSY) matrix, S in the first LengthSY columns*/
+		double *SYinp; /*CompactForm: (2 LengthSY) x LengthSY matrix, the column idx is [S Y]^T y_idx^flat*/
+		double *SYwork; /*CompactForm: workspace of HvLRBFGSCompact, 6 LengthSY + 2 LengthSY^2 doubles after SYinp*/
 		std::list<double> pre_BBs; /* Store a few computed BB stepsize ss/sy for initial Hessian approximation using adaptive BB min (ABB_min) idea*/
 
 		/*===================RBFGS, RBroydenfamily, RTRSR1====================*/
@@ -33,6 +33,10 @@ namespace ROPTLIB{
 		/*Check whether the parameters about RBFGS are legal or not.*/
 		virtual void CheckParams();
 
+		/*Call SolversTR::Reset and set the Hessian approximation B to the identity. Note that the initialB given to
+		the constructor is not kept.*/
+		virtual bool Reset(const Problem *prob, const Variable *initialx);
+
 		/*Initialize the solvers by calling the "SetProbX" and "SetDefultParams" functions.
 		INPUT:	prob is the problem which defines the cost function, gradient and possible the action of Hessian
 		and specifies the manifold of domain.
@@ -2,6 +2,10 @@
 This file defines the abstract base class for storage classes, i.e., points on a manifold,
 tangent vectors, vectors in ambient space, linear operator on a tangent space.
 It uses copy-on-write strategy.
+The reference counter of the shared data is a plain integer, so a SmartSpace and all the copies sharing
+its data must be used by one thread at a time. Different threads work on their own objects and
+never share data, which is how DriverElasticCurvesRO runs its starts and how optimum_reparam can be
+called from several threads at once.
 
 SmartSpace
 
@@ -48,12 +52,14 @@ namespace ROPTLIB{
 		virtual void CopyTo(SmartSpace *eta) const;
 
 		/*Randomly create this SmartSpace. In other words, the space will be allocated based
-		on the size. Then each entry in the space will be generated by the uniform distribution in [start, end].*/
-		virtual void RandUnform(double start = 0, double end = 1);
+		on the size. Then each entry in the space will be generated by the uniform distribution in [start, end].
+		The numbers are drawn from ctx, or from the default context of the calling thread if ctx is nullptr.*/
+		virtual void RandUnform(double start = 0, double end = 1, RandGenContext *ctx = nullptr);
 
 		/*Randomly create this SmartSpace. In other words, the space will be allocated based
-		on the size. Then each entry in the space will be generated by the normal distribution with mean and variance.*/
-		virtual void RandGaussian(double mean = 0, double variance = 1);
+		on the size. Then each entry in the space will be generated by the normal distribution with mean and variance.
+		The numbers are drawn from ctx, or from the default context of the calling thread if ctx is nullptr.*/
+		virtual void RandGaussian(double mean = 0, double variance = 1, RandGenContext *ctx = nullptr);
 
 		/*Obtain this SmartSpace's pointer which points to the data;
 		Users are encouraged to call this function if they only need to use the data, not to modify the data.
@@ -47,6 +47,27 @@ namespace ROPTLIB{
 	*/
 	enum DEBUGINFO{ NOOUTPUT, FINALRESULT, ITERRESULT, DETAILED, DEBUGLENGTH };
 
+	/*Operations timed by the solver telemetry, see SolverTelemetry.
+	TELE_F: cost function, TELE_GRAD: gradient,
+	TELE_FUNCGRAD: cost function and gradient evaluated together by Problem::FuncGrad,
+	TELE_RETRACTION: retraction, TELE_TRANSPORT: vector transport, its inverse and the differentiated retraction,
+	TELE_LINESEARCH: the whole line search, including the evaluations done in it.*/
+	enum TELEOP{ TELE_F, TELE_GRAD, TELE_FUNCGRAD, TELE_RETRACTION, TELE_TRANSPORT, TELE_LINESEARCH, TELEOPLENGTH };
+
+	/*The number of doubles in one per-iteration record of the telemetry:
+	iter, time, f, |gf|, accepted stepsize (line search) or radius (trust region), nf, ng, nR, nV + nVp*/
+#define TELERECORDLENGTH 9
+
+	/*Telemetry of a run, collected without any output. It is enabled by Solvers::SetTelemetry before calling Run.
+	The times are added to "times", so that one SolverTelemetry can sum several runs. A record is appended after the
+	initial iterate and after each iteration as long as "length" is less than "capacity".*/
+	struct SolverTelemetry{
+		double times[TELEOPLENGTH]; /*cumulative wall time (second) of each operation*/
+		double *records; /*caller-supplied buffer of capacity * TELERECORDLENGTH doubles, or nullptr*/
+		integer capacity; /*the number of records that fit in "records"*/
+		integer length; /*the number of records written*/
+	};
+
 	class Solvers{
 	public:
 		/*Run the algorithm. In this class, this function only initialize debug information and output the name of algorithm.
@@ -56,6 +77,14 @@ namespace ROPTLIB{
 		/*Check whether the general parameters are legal or not.*/
 		virtual void CheckParams();
 
+		/*Rebind the solver to the problem prob and the initial iterate initialx and reset the state of the previous run,
+		such that Run can be called again without constructing a new solver. The iterates, vectors and buffers of the
+		solver are reused and the parameters are kept, so the domain of prob must have the same representation and sizes
+		as the domain of the problem given to the constructor. The previous problem may have been deleted.
+		OUTPUT: true if the solver is reset. false if the domain of prob does not match the solver; the solver is then not
+		reset, still refers to the previous problem and must not be run.*/
+		virtual bool Reset(const Problem *prob, const Variable *initialx);
+
 		/*Output all the results after calling the "Run" function.*/
 		virtual void OutPutResults(Variable *inx1, double &inf1, double &inngf0, double &inngf, integer &initer,
 			integer &innf, integer &inng, integer &innR, integer &innV, integer &innVp, double &inComTime,
@@ -115,6 +144,13 @@ namespace ROPTLIB{
 		inline double *GetgradSeries(void) const { return gradSeries; };
 		inline double *GetdistSeries(void) const { return distSeries; };
 
+		/*Collect the telemetry of the next runs in intele, or stop collecting it if intele is nullptr.
+		The caller owns intele, which must stay valid during the runs.*/
+		inline void SetTelemetry(SolverTelemetry *intele) { Tele = intele; };
+
+		/*Get the telemetry set by SetTelemetry*/
+		inline SolverTelemetry *GetTelemetry(void) const { return Tele; };
+
 		/*PARAMSMAP is defined in "def.h" and it is a map from string to double, i.e., std::map<std::string, double> .
 		This function is used to set the parameters by the mapping*/
 		virtual void SetParams(PARAMSMAP params);
@@ -228,6 +264,7 @@ namespace ROPTLIB{
 		// Input parameters and functions
 		const Manifold *Mani;	/*The manifold on which the cost function is*/
 		const Problem *Prob;	/*The problem which defines the cost function, gradient and probably action of Hessian*/
+		bool ProbUseGrad, ProbUseHess; /*UseGrad and UseHess of the problem as set by SetProbX, which Reset gives to the new problem*/
 
 		// For debug information
 		integer iter; /*number of iterations*/
@@ -244,6 +281,16 @@ namespace ROPTLIB{
 		integer lengthSeries;		/*the length of above four arrays, i.e., the length of timeSeries, funSeries, gradSeries, distSeries.*/
 		std::string SolverName; /*The name of the solver. This is assigned in the constructor function of each derived class*/
 
+		SolverTelemetry *Tele; /*telemetry of the run, nullptr if it is not collected*/
+		unsigned long TeleTicks[TELEOPLENGTH]; /*start times of the operations being timed*/
+
+		/*Start and stop timing an operation. They do nothing if the telemetry is not collected.*/
+		inline void TeleTic(TELEOP op) { if (Tele != nullptr) TeleTicks[op] = getTickCount(); };
+		inline void TeleToc(TELEOP op) { if (Tele != nullptr) Tele->times[op] += static_cast<double>(getTickCount() - TeleTicks[op]) / CLK_PS; };
+
+		/*Append the record of the current iterate to the telemetry*/
+		void TeleRecord(double f, double step);
+
 		/*new memory for the double array Vs, type Vector, with length l*/
 		void NewVectors(Vector ** &Vs, integer l);
 
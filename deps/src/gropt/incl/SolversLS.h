@@ -66,6 +66,9 @@ namespace ROPTLIB{
 		This function is used to set the parameters by the mapping*/
 		virtual void SetParams(PARAMSMAP params);
 
+		/*Call Solvers::Reset and clear the stored BB stepsizes of the previous run. Return false if the solver is not reset.*/
+		virtual bool Reset(const Problem *prob, const Variable *initialx);
+
 		/*Beside the four line search algorithms provided in this library and specified by the member variable "LineSearch_LS",
 		user also can define a line search algorithm by assigning the following function pointer.
 		User needs to assign LineSearch_LS to be INPUTFUN to call this function. */
@@ -185,6 +188,13 @@ namespace ROPTLIB{
 		/*Evaluate the derivative of cost function h, i.e., h'(stepsize) = \frac{d}{d stepsize} f(R_{x_1}(stepsize * eta1))*/
 		virtual double dh(void);
 
+		/*Evaluate h(stepsize) as "h" does and the gradient gf2 at x2 by Problem::FuncGrad*/
+		virtual double hg(void);
+
+		/*Evaluate the cost function at x and its gradient gf by Problem::FuncGrad if Problem::HasFuncGrad, and by
+		Problem::f and Problem::Grad otherwise, which are recorded as TELE_F and TELE_GRAD in the telemetry.*/
+		double FuncGrad(Variable *x, Vector *gf);
+
 		/*When one iteration, some algorithms need to update some information. For example,
 		quasi-Newton methods need to update the Hessian approximation and nonlinear conjugate gradient
 		needs to update the search direction. They are done in the following function*/
@@ -36,6 +36,24 @@ namespace ROPTLIB{
 		static void SecondDeri(const double *coefs, int N, double *dericoefs);
 		static double ValSecondDeriUniform(const double *dericoefs, int N, double h, double t);
 		static double ValSecondDeri(const double *dericoefs, const double *breaks, int N, double t);
+
+		/* Batch evaluation of d splines on uniform knots. coefs holds d splines with "order" coefficients
+		per interval in the layout of the functions above, i.e., d blocks of (N - 1) by order matrices.
+		InterleaveUniform stores them per interval in icoefs, i.e., icoefs[(i * d + j) * order + k] is the
+		k-th coefficient of the j-th spline on the i-th interval, so that all the coefficients used by one
+		point are contiguous. */
+		static void InterleaveUniform(const double *coefs, int N, int d, int order, double *icoefs);
+		/* result(i, j) is the value of the j-th spline (order 4) at t[i], result is m by d. The interval of
+		t[i] is found once for all the d splines. The values agree with ValSplineUniform. */
+		static void ValSplineUniformBatch(const double *icoefs, int N, int d, double h, const double *t, int m, double *result);
+		/* The values and the first derivatives of the splines (order 4) at the same points. deriresult(i, j) agrees with
+		ValFirstDeriUniform applied to the coefficients given by FirstDeri. */
+		static void ValSplineAndFirstDeriUniformBatch(const double *icoefs, int N, int d, double h, const double *t, int m,
+			double *result, double *deriresult);
+		/* The same for the first derivatives (order 3), see ValFirstDeriUniform */
+		static void ValFirstDeriUniformBatch(const double *icoefs, int N, int d, double h, const double *t, int m, double *result);
+		/* The same for the second derivatives (order 2), see ValSecondDeriUniform */
+		static void ValSecondDeriUniformBatch(const double *icoefs, int N, int d, double h, const double *t, int m, double *result);
 	};
 }; /*end of ROPTLIB namespace*/
 #endif // SPLINE_H
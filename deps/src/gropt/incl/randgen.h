@@ -1,7 +1,13 @@
 
-/*wrapper for the C++ default random generator
+/*wrapper for the random generator
  * it can be replaced by any other random generator if necessary
  *
+ * The generator is xoshiro256** by Blackman and Vigna. Its state is kept in a RandGenContext.
+ * Every thread has its own default context, which is used by the functions without a context
+ * argument, so calls from different threads do not share any state. A caller that needs its
+ * own stream passes its own context. genrandsubstream splits one seed into independent
+ * substreams, one per task, such that the numbers drawn by a task do not depend on which
+ * thread runs it.
  *
  * --by Wen Huang*/
 
@@ -12,14 +18,32 @@
 #include <random>
 #include <stdio.h>
 #include <iostream>
+#include <cstdint>
+
+/* state of a random generator */
+struct RandGenContext{
+	uint64_t s[4];
+};
+
+/* the default context of the calling thread */
+RandGenContext *genranddefault();
 
 /* initializes  a seed */
 void genrandseed(unsigned int s);
+void genrandseed(RandGenContext *ctx, unsigned int s);
+
+/* advances ctx by 2^128 numbers. The streams obtained by repeated jumps do not overlap. */
+void genrandjump(RandGenContext *ctx);
+
+/* sets result to the k-th substream of ctx, i.e., ctx advanced by k jumps. ctx is not changed. */
+void genrandsubstream(const RandGenContext *ctx, unsigned int k, RandGenContext *result);
 
-/* generates a random number on [0,1]-real-interval */
+/* generates a random number on [0,1)-real-interval */
 double genrandreal();
+double genrandreal(RandGenContext *ctx);
 
 /* generate a random number following the standard normal distribution*/
 double genrandnormal();
+double genrandnormal(RandGenContext *ctx);
 
 #endif
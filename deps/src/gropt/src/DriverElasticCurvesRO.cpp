@@ -1,19 +1,22 @@
 
 #include "DriverElasticCurvesRO.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 /*Define the namespace*/
 namespace ROPTLIB{
 
 	void DriverElasticCurvesRO(double *C1, double *C2, integer d, integer n, double w, bool rotated, bool isclosed,
 		bool onlyDP, integer skipm, std::string solverstr, integer autoselectC, ProductElement *Xopt, bool &swap, double *fopts,
-		double *comtime, integer &Nsout, integer &numinitialx, double *optQ1, double *optQ2)
+		double *comtime, integer &Nsout, integer &numinitialx, double *optQ1, double *optQ2,
+		const DriverElasticCurvesROOptions &options)
 	{ // The first and last point of C1 and C2 should be the same if they are viewed as closed curves, i.e., isclosed = true.
 		double threshold = PI / 2;
+		SolverTelemetry *telemetry = options.telemetry;
 		integer minSkip = skipm;
 		integer randshift = 0;
-		bool computeCD1 = false;
 
-		Solvers *solver = nullptr;
 		// Let C2 be the complex one
 		double TAC1 = ComputeTotalAngle(C1, d, n);
 		double TAC2 = ComputeTotalAngle(C2, d, n);
@@ -62,9 +65,7 @@ namespace ROPTLIB{
 					if (TAC2 > TAC1)
 					{
 						FindInitialBreaksAndNs(C2, d, n, minSkip, threshold, randshift, ms, lms, ns);
-						ns = static_cast<int> (static_cast<double> (n) / 3);
-						ns = (ns > 30) ? 30 : ns;
-						ns += static_cast<int> (TAC1 / PI * 2.0);
+						ns = CoarseNumPoints(n, TAC1);
 					}
 					else
 					{
@@ -73,9 +74,7 @@ namespace ROPTLIB{
 						{
 							ms[i] = n - ms[i];
 						}
-						ns = static_cast<int> (static_cast<double> (n) / 3);
-						ns = (ns > 30) ? 30 : ns;
-						ns += static_cast<int> (TAC1 / PI * 2.0);
+						ns = CoarseNumPoints(n, TAC1);
 					}
 				}
 				else
@@ -83,9 +82,7 @@ namespace ROPTLIB{
 					if (TAC2 < TAC1)
 					{
 						FindInitialBreaksAndNs(C2, d, n, minSkip, threshold, randshift, ms, lms, ns);
-						ns = static_cast<int> (static_cast<double> (n) / 3);
-						ns = (ns > 30) ? 30 : ns;
-						ns += static_cast<int> (TAC1 / PI * 2.0);
+						ns = CoarseNumPoints(n, TAC1);
 					}
 					else
 					{
@@ -94,9 +91,7 @@ namespace ROPTLIB{
 						{
 							ms[i] = n - ms[i];
 						}
-						ns = static_cast<int> (static_cast<double> (n) / 3);
-						ns = (ns > 30) ? 30 : ns;
-						ns += static_cast<int> (TAC2 / PI * 2.0);
+						ns = CoarseNumPoints(n, TAC2);
 					}
 				}
 			}
@@ -107,75 +102,21 @@ namespace ROPTLIB{
 			lms = 1;
 			if (!onlyDP)
 			{
-				ns = static_cast<int> (static_cast<double> (n) / 3);
-				ns = (ns > 30) ? 30 : ns;
-				ns += static_cast<int> (TAC2 / PI * 2.0);
+				ns = CoarseNumPoints(n, TAC2);
 			}
 		}
 
 		Nsout = ns;
 		numinitialx = lms;
 
-		// create manifold and initial iterate objects.
-		integer numofmanis = 3;
-		integer numofmani1 = 1;
-		integer numofmani2 = 1;
-		integer numofmani3 = 1;
-		L2Sphere TNS(n);
-		OrthGroup OG(d);
-		Euclidean Euc(1);
-		ProductManifold *Domain = nullptr;
-		Domain = new ProductManifold(numofmanis, &TNS, numofmani1, &OG, numofmani2, &Euc, numofmani3);
-
-		// 	Domain->SetIsIntrApproach(false);
-
-		L2SphereVariable TNSV(n);
-		OrthGroupVariable OGV(d);
-		EucVariable EucV(1);
-		ProductElement *InitialX = nullptr;
-		InitialX = new ProductElement(numofmanis, &TNSV, numofmani1, &OGV, numofmani2, &EucV, numofmani3);
-		double *Xptr = InitialX->ObtainWriteEntireData();
-
-		// initialize rotation to be identity and shift to be zero
-		Xptr[n + d * d] = 0;
-		for (integer j = 0; j < d; j++)
-		{
-			Xptr[n + j + j * d] = 1;
-			for (integer k = j + 1; k < d; k++)
-			{
-				Xptr[n + k + j * d] = 0;
-				Xptr[n + j + k * d] = 0;
-			}
-		}
-
-
 		// find initialX for each break and run the solver
-		ElasticCurvesRO *ECRO = nullptr;
-		double *C2shift = new double[5 * d * n + d * d + n + lms + 2 * d * d];
-		double *q2shift = C2shift + d * n;
-		double *q1 = q2shift + d * n;
-		double *O = q1 + d * n;
-		double *Rotq2shift = O + d * d;
-		double *RotC2shift = Rotq2shift + d * n;
-		double *DPgam = RotC2shift + d * n;
-		double *msV = DPgam + n;
-		double *O2 = msV + lms;
-		double *O3 = O2 + d * d; // d * d
-
-		double *C1s = nullptr, *C2s = nullptr, *q1s = nullptr, *q2s = nullptr, *DPgams = nullptr;
+		double *q1 = new double[d * n + n];
+		double *msV = q1 + d * n;
+		double *C1s = nullptr, *q1s = nullptr;
 		if (!onlyDP)
 		{
-			C1s = new double[4 * d * ns + ns];
-			C2s = C1s + d * ns;
-			q1s = C2s + d * ns;
-			q2s = q1s + d * ns;
-			DPgams = q2s + d * ns; // ns
-		}
-		double *C2_coefs = nullptr, *q2 = nullptr;
-		if (onlyDP)
-		{
-			C2_coefs = new double[4 * d * (n - 1) + n * d];
-			q2 = C2_coefs + 4 * d * (n - 1);
+			C1s = new double[2 * d * ns];
+			q1s = C1s + d * ns;
 		}
 
 		if (optQ1 == nullptr)
@@ -186,16 +127,114 @@ namespace ROPTLIB{
 			dcopy_(&len, optQ1, &GLOBAL::IONE, q1, &GLOBAL::IONE);
 		}
 
-		char *transn = const_cast<char *> ("n"), *transt = const_cast<char *> ("t");
-		double one = 1, zero = 0;
-		integer dd = d * d, inc = 1;
+		// q2 of C2 for the seeding by shift scores and, for closed curves, its periodic splines, which are shared by
+		// the problems of all the starts since a break point only shifts the intervals
+		double *q2 = nullptr, *q2coefs = nullptr;
+		if (isclosed && (options.numseeds > 0 || !onlyDP))
+		{
+			q2 = new double[d * n + n + ((onlyDP) ? 0 : 4 * d * (n - 1))];
+			if (optQ2 == nullptr)
+				CurveToQ(C2, d, n, q2, isclosed);
+			else
+			{
+				integer len = d * n;
+				dcopy_(&len, optQ2, &GLOBAL::IONE, q2, &GLOBAL::IONE);
+			}
+			if (!onlyDP)
+			{
+				q2coefs = q2 + d * n + n;
+				for (integer j = 0; j < d; j++)
+					Spline::SplineUniformPeriodic(q2 + j * n, n, 1.0 / (n - 1), q2coefs + j * 4 * (n - 1));
+			}
+		}
+
+		// refine the warm start first. If it barely moves, it is taken as Xopt and the other starts are skipped,
+		// otherwise it competes with them in the reduction below.
+		double *Xw = nullptr;
+		double fwarm = 1000, finit = 0, warmtime = 0;
+		integer warmlength = 0;
+		if (options.Xinit != nullptr && !onlyDP && swap == options.swapinit)
+		{
+			unsigned long warmstart = getTickCount();
+			integer sizew = n + d * d + 1;
+			Xw = new double[sizew + 4 * d * n + n + 3 * d * d];
+			SolverTelemetry *warmtele = nullptr;
+			SolverTelemetry tele;
+			if (telemetry != nullptr)
+			{ // the records are written after telemetry->length and only kept if the warm start gives Xopt
+				for (integer j = 0; j < TELEOPLENGTH; j++)
+					tele.times[j] = 0;
+				tele.records = (telemetry->records == nullptr) ? nullptr : telemetry->records + telemetry->length * TELERECORDLENGTH;
+				tele.capacity = (telemetry->records == nullptr) ? 0 : telemetry->capacity - telemetry->length;
+				tele.length = 0;
+				warmtele = &tele;
+			}
+			if (ElasticCurvesROWarmStart(C2, optQ2, q1, d, n, w, rotated, isclosed, solverstr, options.Xinit, Xw + sizew, Xw,
+				fwarm, finit, warmtele, q2coefs))
+			{
+				warmtime = static_cast<double>(getTickCount() - warmstart) / CLK_PS;
+				if (telemetry != nullptr)
+				{
+					for (integer j = 0; j < TELEOPLENGTH; j++)
+						telemetry->times[j] += tele.times[j];
+				}
+				if (options.warmtol >= 0 && finit - fwarm <= options.warmtol * finit)
+				{
+					double *Xoptptr = Xopt->ObtainWriteEntireData();
+					// Xoptptr <- Xw, details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+					dcopy_(&sizew, Xw, &GLOBAL::IONE, Xoptptr, &GLOBAL::IONE);
+					for (integer i = 0; i < 5; i++)
+					{
+						fopts[i] = fwarm;
+						comtime[i] = warmtime;
+					}
+					if (telemetry != nullptr)
+						telemetry->length += tele.length;
+					numinitialx = 0;
+					delete[] Xw;
+					delete[] q1;
+					if (q2 != nullptr)
+						delete[] q2;
+					if (C1s != nullptr)
+					{
+						delete[] C1s;
+					}
+					delete[] ms;
+					return;
+				}
+				warmlength = tele.length;
+			}
+			else
+			{ // the solver is unknown, which is reported by the other starts
+				delete[] Xw;
+				Xw = nullptr;
+			}
+		}
+
+		if (isclosed && options.numseeds > 0)
+		{ // replace the break points by the shifts of C2 that best match C1 up to rotation
+			double *E = q2 + d * n;
+			ShiftRotationScores(q1, q2, d, n, rotated, E);
+			FindSeedsByScores(E, n, options.numseeds, (minSkip < 1) ? 1 : minSkip, ms, lms);
+			numinitialx = lms;
+		}
+
+		integer inc = 1;
 		unsigned long starttime = getTickCount();
 		double minmsV = 10000;
 
 		if (!onlyDP)
 		{ // use coarse point to represent C1
-			GetCurveSmall(C1, C1s, d, n, ns, isclosed);
-			CurveToQ(C1s, d, ns, q1s, isclosed);
+			if (options.optC1s != nullptr && !swap && options.optns == ns)
+			{
+				integer len = 2 * d * ns;
+				dcopy_(&len, const_cast<double *> (options.optC1s), &GLOBAL::IONE, C1s, &GLOBAL::IONE);
+			}
+			else
+			{
+				GetCurveSmall(C1, C1s, d, n, ns, isclosed);
+				CurveToQ(C1s, d, ns, q1s, isclosed);
+			}
 		}
 		// printf("lms:%d, ns:%d\n", lms, ns);
 
@@ -208,275 +247,665 @@ namespace ROPTLIB{
 			comtime[i] = static_cast<double>(getTickCount() - starttime) / CLK_PS;
 		}
 
-		for (integer i = 0; i < lms; i++) //lms
+		// The starts only share read-only data, so they run on OpenMP threads. Each thread owns
+		// its workspace and each start builds its own problem and solver. The candidates are kept
+		// in Xs and reduced below in the original order, so the result does not depend on the
+		// number of threads.
+		integer sizex = n + d * d + 1;
+		integer lwork = 4 * d * n + n + 3 * d * d + ((onlyDP) ? 4 * d * (n - 1) + n * d : 2 * d * ns + ns);
+		double *Xs = new double[lms * sizex + lms];
+		double *ts = Xs + lms * sizex;
+		bool knownsolver = true;
+
+		// every start collects its telemetry separately, in its own segment of telerecords
+		SolverTelemetry *teles = nullptr;
+		double *telerecords = nullptr;
+		integer telecapacity = 0;
+		if (telemetry != nullptr)
 		{
-			// printf("%d, ", ms[i]);
-			starttime = getTickCount();
-			// obtain initial reparameterization
-			ShiftC(C2, d, n, C2shift, ms[i]);
-			if (optQ2 == nullptr)
-				CurveToQ(C2shift, d, n, q2shift, isclosed);
-			else
-				ShiftC(optQ2, d, n, q2shift, ms[i]);
-
-			if (rotated)
-			{ // if rotation is considered, rotate C2.
-				FindBestRotation(q1, q2shift, d, n, O);
-				// Rotq2shift <- q2shift * O^T, details: http://www.netlib.org/lapack/explore-html/d7/d2b/dgemm_8f.html
-				dgemm_(transn, transt, &n, &d, &d, &one, q2shift, &n, O, &d, &zero, Rotq2shift, &n);
-				// RotC2shift <- C2shift * O^T, details: http://www.netlib.org/lapack/explore-html/d7/d2b/dgemm_8f.html
-				dgemm_(transn, transt, &n, &d, &d, &one, C2shift, &n, O, &d, &zero, RotC2shift, &n);
-			}
-			else
-			{ // Otherwise, keep C2.
-				integer nd = n * d, inc = 1;
-				// Rotq2shift <- q2shift, details:http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
-				dcopy_(&nd, q2shift, &inc, Rotq2shift, &inc);
-				// RotC2shift <- C2shift, details:http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
-				dcopy_(&nd, C2shift, &inc, RotC2shift, &inc);
-			}
-
-			if (!onlyDP)
-			{ // if use Riemannian method, use coarse points to represent C2 and compute the initial gamma.
-				GetCurveSmall(RotC2shift, C2s, d, n, ns, isclosed);
-				CurveToQ(C2s, d, ns, q2s, isclosed);
-				DynamicProgramming(q2s, q1s, d, ns, DPgams, isclosed, NUMSMALL);
-				ReSampleGamma(DPgams, ns, DPgam, n);
-			}
-			else
-			{ // if only use DP, then use dense grid to compute gamma
-				DynamicProgramming(Rotq2shift, q1, d, n, DPgam, isclosed, NUMBIG);
-
-				if (rotated)
-				{ // if rotation is consider, then an extra rotation is computed.
-					if (computeCD1)
-					{ // if CD1 function value needs to be output, then compute it and output it.
-						if (isclosed)
-							GradientPeriod(DPgam, n, 1.0 / (n - 1), Xptr);
-						else
-							Gradient(DPgam, n, 1.0 / (n - 1), Xptr);
-						for (integer j = 0; j < n; j++)
-						{
-							Xptr[j] = sqrt(Xptr[j]);
-						}
-						ECRO = new ElasticCurvesRO(q1, Rotq2shift, d, n, w, rotated, isclosed);
-						ECRO->SetDomain(Domain);
-						// printf("CD1 func:%g\n", ECRO->f(InitialX));
-					}
-
-					if (isclosed)
-					{
-						for (integer j = 0; j < d; j++)
-						{
-							Spline::SplineUniformPeriodic(RotC2shift + j * n, n, 1.0 / (n - 1), C2_coefs + j * 4 * (n - 1));
-						}
-					}
-					else
-					{
-						for (integer j = 0; j < d; j++)
-						{
-							Spline::SplineUniformSlopes(RotC2shift + j * n, n, 1.0 / (n - 1), C2_coefs + j * 4 * (n - 1));
-						}
-					}
-					for (integer j = 0; j < n; j++)
-					{
-						for (integer k = 0; k < d; k++)
-						{
-							RotC2shift[j + k * n] = Spline::ValSplineUniform(C2_coefs + k * 4 * (n - 1), n, 1.0 / (n - 1), DPgam[j]);
-						}
-					}
-					CurveToQ(RotC2shift, d, n, q2, isclosed);
-					FindBestRotation(q1, q2, d, n, O2);
-					// O3 = O * O2, details: http://www.netlib.org/lapack/explore-html/d7/d2b/dgemm_8f.html
-					dgemm_(transn, transn, &d, &d, &d, &one, O, &d, O2, &d, &zero, O3, &d);
-					// O <- O3, details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
-					dcopy_(&dd, O3, &inc, O, &inc);
-					// Xptr(n : n + d * d - 1) <- reshape(O2, d * d, 1),
-					// details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
-					dcopy_(&dd, O2, &inc, Xptr + n, &inc); // used to evaluate the cost function
-				}
-			}
-
-			if (isclosed)
-				GradientPeriod(DPgam, n, 1.0 / (n - 1), Xptr);
-			else
-				Gradient(DPgam, n, 1.0 / (n - 1), Xptr);
-
-			for (integer j = 0; j < n; j++)
+			teles = new SolverTelemetry[lms];
+			if (telemetry->records != nullptr && telemetry->capacity > telemetry->length)
+				telecapacity = telemetry->capacity - telemetry->length;
+			if (telecapacity > 0)
+				telerecords = new double[lms * telecapacity * TELERECORDLENGTH];
+			for (integer i = 0; i < lms; i++)
 			{
-				Xptr[j] = sqrt(Xptr[j]);
-			}
-			// Compute reparameterization for q1 and rotated and shifted q2;
-			ECRO = new ElasticCurvesRO(q1, Rotq2shift, d, n, w, rotated, isclosed);
-			ECRO->SetDomain(Domain);
-			if (onlyDP)
-			{ // if only DP is used, then output the CD1H cost function
-				ECRO->w = 0;
-				msV[i] = ECRO->f(InitialX);
-				// printf("CD1H func:%g\n", msV[i]);
+				for (integer j = 0; j < TELEOPLENGTH; j++)
+					teles[i].times[j] = 0;
+				teles[i].records = (telerecords == nullptr) ? nullptr : telerecords + i * telecapacity * TELERECORDLENGTH;
+				teles[i].capacity = telecapacity;
+				teles[i].length = 0;
 			}
-			if (!onlyDP)
-			{ // if a Riemannian method is used, then Xinitial is the initial iterate and a method is used.
-				if (solverstr == "RBFGS")
-				{
-					solver = new RBFGS(ECRO, InitialX);
-					dynamic_cast<SolversLS *> (solver)->Initstepsize = 0.001;
-				}
-				else
-				if (solverstr == "LRBFGS")
-				{
-					solver = new LRBFGS(ECRO, InitialX);
-					dynamic_cast<SolversLS *> (solver)->Initstepsize = 0.001;
-				}
-				else
-				if (solverstr == "RCG")
-				{
-					solver = new RCG(ECRO, InitialX);
-					dynamic_cast<SolversLS *> (solver)->Initstepsize = 0.001;
-				}
-				else
-				if (solverstr == "RSD")
-				{
-					solver = new RSD(ECRO, InitialX);
-					dynamic_cast<SolversLS *> (solver)->Initstepsize = 0.001;
-				}
-				else
-				if (solverstr == "RTRSR1")
+		}
+		integer nthreads = options.nthreads;
+#ifdef _OPENMP
+		if (nthreads <= 0)
+			nthreads = omp_get_max_threads();
+#endif
+
+		// runs lists the break points that are refined, in increasing order.
+		integer *runs = new integer[2 * lms];
+		integer *isrun = runs + lms;
+		integer nruns = lms;
+		double screentime = 0;
+		// the seeds of the screened break points, reused by the refined starts (see ElasticCurvesROSeed)
+		integer lseed = 1 + d * d + ns;
+		double *seeds = nullptr;
+		for (integer i = 0; i < lms; i++)
+		{
+			runs[i] = i;
+			isrun[i] = 1;
+		}
+		if (!onlyDP && options.numrefine > 0 && options.numrefine < lms)
+		{ // screen every break point by the coarse DP energy and keep the numrefine lowest ones.
+			unsigned long screenstart = getTickCount();
+			seeds = new double[lms * lseed];
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+			{
+				double *work = new double[lwork];
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+				for (integer i = 0; i < lms; i++)
 				{
-					solver = new RTRSR1(ECRO, InitialX);
-					dynamic_cast<SolversTR *> (solver)->kappa = 0.1;
-					dynamic_cast<SolversTR *> (solver)->theta = 1.0;
+					msV[i] = ElasticCurvesROSeed(C2, optQ2, q1, q1s, d, n, ns, rotated, isclosed, onlyDP, ms[i], work,
+						nullptr, seeds + i * lseed);
 				}
-				else
-				if (solverstr == "LRTRSR1")
+				delete[] work;
+			}
+
+			for (integer i = 0; i < lms; i++)
+				isrun[i] = 0;
+			for (integer k = 0; k < options.numrefine; k++)
+			{ // ties go to the earlier break point
+				integer best = -1;
+				for (integer i = 0; i < lms; i++)
 				{
-					solver = new LRTRSR1(ECRO, InitialX);
-					dynamic_cast<SolversTR *> (solver)->kappa = 0.1;
-					dynamic_cast<SolversTR *> (solver)->theta = 1.0;
+					if (!isrun[i] && (best < 0 || msV[i] < msV[best]))
+						best = i;
 				}
-				else
-				if (solverstr == "RTRSD")
+				isrun[best] = 1;
+			}
+			nruns = 0;
+			for (integer i = 0; i < lms; i++)
+			{
+				if (isrun[i])
 				{
-					solver = new RTRSD(ECRO, InitialX);
+					runs[nruns] = i;
+					nruns++;
 				}
-				else
+			}
+			screentime = static_cast<double>(getTickCount() - screenstart) / CLK_PS;
+		}
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+		{
+			double *work = new double[lwork];
+			Solvers *solver = nullptr; // reused by the starts of this thread
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+			for (integer r = 0; r < nruns; r++) //lms
+			{
+				integer i = runs[r];
+				unsigned long startitime = getTickCount();
+				if (!ElasticCurvesROStart(C2, optQ2, q1, q1s, d, n, ns, w, rotated, isclosed, onlyDP, ms[i],
+					solverstr, work, Xs + i * sizex, msV[i], (teles == nullptr) ? nullptr : teles + i, q2coefs, &solver,
+					(seeds == nullptr) ? nullptr : seeds + i * lseed))
 				{
-					printf("This solver is not used in this problem!\n");
-					delete ECRO;
-					delete solver;
-					delete[] C2shift;
-					if (C2_coefs != nullptr)
-					{
-						delete[] C2_coefs;
-					}
-					if (C1s != nullptr)
-					{
-						delete[] C1s;
-					}
-					delete[] ms;
-					delete Domain;
-					delete InitialX;
-					return;
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+					knownsolver = false;
 				}
-				solver->Max_Iteration = 500;
-				solver->Min_Iteration = 10;
-				solver->Debug = NOOUTPUT; //--FINALRESULT;//--NOOUTPUT; //ITERRESULT
-				solver->Stop_Criterion = FUN_REL;
-				solver->Tolerance = 1e-3;
-				solver->Run();
-				ECRO->w = 0;
-				//--Xopt->RemoveAllFromTempData();
-				msV[i] = ECRO->f(const_cast<Element *> (solver->GetXopt()));
-				// printf("%s func:%g, num of iter:%d\n", solverstr.c_str(), msV[i], solver->GetIter());
+				ts[i] = static_cast<double>(getTickCount() - startitime) / CLK_PS;
 			}
-			delete ECRO;
+			if (solver != nullptr)
+				delete solver;
+			delete[] work;
+#ifdef _OPENMP
+			// the worker threads outlive this call, so they give back the buffers they cached
+			if (omp_get_thread_num() != 0)
+				MemoryPool::Release();
+#endif
+		}
+		if (seeds != nullptr)
+			delete[] seeds;
+
+		if (!knownsolver)
+		{
+			printf("This solver is not used in this problem!\n");
+			if (Xw != nullptr)
+				delete[] Xw;
+			if (teles != nullptr)
+			{
+				delete[] teles;
+				if (telerecords != nullptr)
+					delete[] telerecords;
+			}
+			delete[] runs;
+			delete[] Xs;
+			delete[] q1;
+			if (q2 != nullptr)
+				delete[] q2;
+			if (C1s != nullptr)
+			{
+				delete[] C1s;
+			}
+			delete[] ms;
+			return;
+		}
+
+		// the screening time is charged to every stride
+		for (integer i = 0; i < 5; i++)
+			comtime[i] += screentime;
+
+		integer best = -1;
+		for (integer i = 0; i < lms; i++)
+		{
+			if (!isrun[i])
+				continue;
 
 			if (msV[i] < minmsV)
 			{
 				minmsV = msV[i];
-				if (onlyDP)
-				{
-					for (integer j = 0; j < n; j++)
-					{
-						Xoptptr[j] = DPgam[j];
-					}
-					// Xoptptr(n:n+d*d - 1) <- reshape(O, d * d, 1)
-					// details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
-					dcopy_(&dd, O, &inc, Xoptptr + n, &inc);
-					Xoptptr[n + d * d] = static_cast<double> (ms[i]) / (n - 1);
-				}
-				else
-				{
-					solver->GetXopt()->CopyTo(Xopt);
-					Xoptptr = Xopt->ObtainWritePartialData();
-					for (integer j = 0; j < n; j++)
-					{
-						Xoptptr[j] *= Xoptptr[j];
-					}
-					double tmp1 = Xoptptr[0], tmp2 = 0;
-					Xoptptr[0] = 0;
-					for (integer j = 1; j < n; j++)
-					{
-						tmp2 = Xoptptr[j];
-						Xoptptr[j] = Xoptptr[j - 1] + (tmp1 + tmp2) / 2 / (n - 1);
-						tmp1 = tmp2;
-					}
-					// O2 = O * reshape(Xoptptr(n : n + d * d - 1), d, d)^T,
-					// details: http://www.netlib.org/lapack/explore-html/d7/d2b/dgemm_8f.html
-					dgemm_(transn, transt, &d, &d, &d, &one, O, &d, Xoptptr + n, &d, &zero, O2, &d);
-					// Xoptptr(n:n + d * d - 1) <- reshape(O2, d * d, 1)
-					// details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
-					dcopy_(&dd, O2, &inc, Xoptptr + n, &inc);
-
-					Xoptptr[n + d * d] = Xoptptr[n + d * d] + static_cast<double> (ms[i]) / (n - 1);
-				}
+				best = i;
+				// Xoptptr <- Xs(:, i), details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+				dcopy_(&sizex, Xs + i * sizex, &inc, Xoptptr, &inc);
 			}
-			if (!onlyDP)
-				delete solver;
 
-			comtime[0] += (double)(getTickCount() - starttime) / CLK_PS;
+			comtime[0] += ts[i];
 			if (msV[i] < fopts[0])
 				fopts[0] = msV[i];
 			if (i % 2 == 0)
 			{
-				comtime[1] += (double)(getTickCount() - starttime) / CLK_PS;
+				comtime[1] += ts[i];
 				if (msV[i] < fopts[1])
 					fopts[1] = msV[i];
 			}
 			if (i % 4 == 0)
 			{
-				comtime[2] += (double)(getTickCount() - starttime) / CLK_PS;
+				comtime[2] += ts[i];
 				if (msV[i] < fopts[2])
 					fopts[2] = msV[i];
 			}
 			if (i % 8 == 0)
 			{
-				comtime[3] += (double)(getTickCount() - starttime) / CLK_PS;
+				comtime[3] += ts[i];
 				if (msV[i] < fopts[3])
 					fopts[3] = msV[i];
 			}
 			if (i % 16 == 0)
 			{
-				comtime[4] += (double)(getTickCount() - starttime) / CLK_PS;
+				comtime[4] += ts[i];
 				if (msV[i] < fopts[4])
 					fopts[4] = msV[i];
 			}
 		}
 
-		// printf("min f:%3.2e\n", minmsV);
-		// printf("time:%3.2e\n", comtime[0]);
-		delete[] C2shift;
-		if (C2_coefs != nullptr)
+		if (Xw != nullptr)
+		{ // the warm start counts in every stride
+			for (integer i = 0; i < 5; i++)
+			{
+				comtime[i] += warmtime;
+				if (fwarm < fopts[i])
+					fopts[i] = fwarm;
+			}
+			if (fwarm < minmsV)
+			{
+				minmsV = fwarm;
+				best = -1;
+				// Xoptptr <- Xw, details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+				dcopy_(&sizex, Xw, &inc, Xoptptr, &inc);
+				if (telemetry != nullptr)
+					telemetry->length += warmlength;
+			}
+			delete[] Xw;
+		}
+
+		if (teles != nullptr)
 		{
-			delete[] C2_coefs;
+			for (integer r = 0; r < nruns; r++)
+			{
+				for (integer j = 0; j < TELEOPLENGTH; j++)
+					telemetry->times[j] += teles[runs[r]].times[j];
+			}
+			if (best >= 0 && telerecords != nullptr)
+			{
+				integer len = teles[best].length * TELERECORDLENGTH;
+				// telemetry->records(length) <- records of the best start,
+				// details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+				dcopy_(&len, teles[best].records, &inc, telemetry->records + telemetry->length * TELERECORDLENGTH, &inc);
+				telemetry->length += teles[best].length;
+			}
+			delete[] teles;
+			if (telerecords != nullptr)
+				delete[] telerecords;
 		}
+
+		// printf("min f:%3.2e\n", minmsV);
+		// printf("time:%3.2e\n", comtime[0]);
+		delete[] runs;
+		delete[] Xs;
+		delete[] q1;
+		if (q2 != nullptr)
+			delete[] q2;
 		if (C1s != nullptr)
 		{
 			delete[] C1s;
 		}
 		delete[] ms;
-		delete InitialX;
+	};
+
+	bool ElasticCurvesROStart(const double *C2, const double *optQ2, double *q1, const double *q1s, integer d, integer n,
+		integer ns, double w, bool rotated, bool isclosed, bool onlyDP, integer ms, std::string solverstr, double *work,
+		double *Xs, double &fopt, SolverTelemetry *telemetry, const double *q2coefs, Solvers **cache, const double *seed)
+	{
+		bool computeCD1 = false;
+
+		// create manifold and initial iterate objects.
+		Manifold *Domain = NewElasticCurvesManifold(n, d);
+		ElasticCurvesVariable InitialX(n, d);
+		double *Xptr = InitialX.ObtainWriteEntireData();
+
+		// initialize rotation to be identity and shift to be zero
+		Xptr[n + d * d] = 0;
+		for (integer j = 0; j < d; j++)
+		{
+			Xptr[n + j + j * d] = 1;
+			for (integer k = j + 1; k < d; k++)
+			{
+				Xptr[n + k + j * d] = 0;
+				Xptr[n + j + k * d] = 0;
+			}
+		}
+
+		ElasticCurvesRO *ECRO = nullptr;
+		double *O = work + 2 * d * n;
+		double *Rotq2shift = O + d * d;
+		double *RotC2shift = Rotq2shift + d * n;
+		double *DPgam = RotC2shift + d * n;
+		double *O2 = DPgam + n;
+		double *O3 = O2 + d * d; // d * d
+		double *C2_coefs = O3 + d * d; // only used if onlyDP
+		double *q2 = C2_coefs + 4 * d * (n - 1);
+
+		char *transn = const_cast<char *> ("n");
+		double one = 1, zero = 0;
+		integer dd = d * d, inc = 1;
+
+		ElasticCurvesROSeed(C2, optQ2, q1, q1s, d, n, ns, rotated, isclosed, onlyDP, ms, work, seed);
+
+		if (onlyDP)
+		{ // if only use DP, then the dense grid gamma is refined by an extra rotation.
+			if (rotated)
+			{ // if rotation is consider, then an extra rotation is computed.
+				if (computeCD1)
+				{ // if CD1 function value needs to be output, then compute it and output it.
+					if (isclosed)
+						GradientPeriod(DPgam, n, 1.0 / (n - 1), Xptr);
+					else
+						Gradient(DPgam, n, 1.0 / (n - 1), Xptr);
+					for (integer j = 0; j < n; j++)
+					{
+						Xptr[j] = sqrt(Xptr[j]);
+					}
+					ECRO = new ElasticCurvesRO(q1, Rotq2shift, d, n, w, rotated, isclosed);
+					ECRO->SetDomain(Domain);
+					// printf("CD1 func:%g\n", ECRO->f(&InitialX));
+					delete ECRO;
+				}
+
+				if (isclosed)
+				{
+					for (integer j = 0; j < d; j++)
+					{
+						Spline::SplineUniformPeriodic(RotC2shift + j * n, n, 1.0 / (n - 1), C2_coefs + j * 4 * (n - 1));
+					}
+				}
+				else
+				{
+					for (integer j = 0; j < d; j++)
+					{
+						Spline::SplineUniformSlopes(RotC2shift + j * n, n, 1.0 / (n - 1), C2_coefs + j * 4 * (n - 1));
+					}
+				}
+				for (integer j = 0; j < n; j++)
+				{
+					for (integer k = 0; k < d; k++)
+					{
+						RotC2shift[j + k * n] = Spline::ValSplineUniform(C2_coefs + k * 4 * (n - 1), n, 1.0 / (n - 1), DPgam[j]);
+					}
+				}
+				CurveToQ(RotC2shift, d, n, q2, isclosed);
+				FindBestRotation(q1, q2, d, n, O2);
+				// O3 = O * O2, details: http://www.netlib.org/lapack/explore-html/d7/d2b/dgemm_8f.html
+				dgemm_(transn, transn, &d, &d, &d, &one, O, &d, O2, &d, &zero, O3, &d);
+				// O <- O3, details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+				dcopy_(&dd, O3, &inc, O, &inc);
+				// Xptr(n : n + d * d - 1) <- reshape(O2, d * d, 1),
+				// details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+				dcopy_(&dd, O2, &inc, Xptr + n, &inc); // used to evaluate the cost function
+			}
+		}
+
+		if (isclosed)
+			GradientPeriod(DPgam, n, 1.0 / (n - 1), Xptr);
+		else
+			Gradient(DPgam, n, 1.0 / (n - 1), Xptr);
+
+		for (integer j = 0; j < n; j++)
+		{
+			Xptr[j] = sqrt(Xptr[j]);
+		}
+		if (onlyDP)
+		{ // if only DP is used, then output the CD1H cost function
+			ECRO = new ElasticCurvesRO(q1, Rotq2shift, d, n, w, rotated, isclosed);
+			ECRO->SetDomain(Domain);
+			ECRO->w = 0;
+			fopt = ECRO->f(&InitialX);
+			// printf("CD1H func:%g\n", fopt);
+
+			for (integer j = 0; j < n; j++)
+			{
+				Xs[j] = DPgam[j];
+			}
+			// Xs(n:n+d*d - 1) <- reshape(O, d * d, 1)
+			// details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+			dcopy_(&dd, O, &inc, Xs + n, &inc);
+			Xs[n + d * d] = static_cast<double> (ms) / (n - 1);
+			delete ECRO;
+			delete Domain;
+			return true;
+		}
+
+		// Compute reparameterization for q1 and rotated and shifted q2;
+		bool result = ElasticCurvesROSolve(q1, Rotq2shift, O, d, n, w, rotated, isclosed, ms, solverstr, Domain, &InitialX, O2, Xs,
+			fopt, telemetry, nullptr, q2coefs, cache);
 		delete Domain;
+		return result;
+	};
+
+	bool ElasticCurvesROWarmStart(const double *C2, const double *optQ2, double *q1, integer d, integer n, double w,
+		bool rotated, bool isclosed, std::string solverstr, const double *Xinit, double *work, double *Xs, double &fopt,
+		double &finit, SolverTelemetry *telemetry, const double *q2coefs, Solvers **cache)
+	{
+		double *C2shift = work;
+		double *q2shift = C2shift + d * n;
+		double *O = q2shift + d * n;
+		double *Rotq2shift = O + d * d;
+		double *O2 = Rotq2shift + 2 * d * n + n; // after RotC2shift and DPgam
+
+		integer dd = d * d, inc = 1;
+
+		// split the shift of Xinit into the break point ms and the rest, which is the initial shift of the solver
+		integer ms = 0;
+		double shift = Xinit[n + d * d];
+		if (isclosed)
+		{
+			shift -= std::floor(shift);
+			ms = static_cast<integer> (std::floor(shift * (n - 1) + 0.5));
+			shift -= static_cast<double> (ms) / (n - 1);
+			if (ms >= n - 1)
+				ms = 0;
+		}
+
+		ShiftC(C2, d, n, C2shift, ms);
+		if (optQ2 == nullptr)
+			CurveToQ(C2shift, d, n, q2shift, isclosed);
+		else
+			ShiftC(optQ2, d, n, q2shift, ms);
+
+		if (rotated)
+		{ // O <- the rotation of Xinit, details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+			dcopy_(&dd, const_cast<double *> (Xinit + n), &inc, O, &inc);
+			// Rotq2shift <- q2shift * O^T
+			RotateCurve(q2shift, O, d, n, Rotq2shift);
+		}
+		else
+		{
+			integer nd = n * d;
+			// Rotq2shift <- q2shift, details:http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+			dcopy_(&nd, q2shift, &inc, Rotq2shift, &inc);
+			for (integer j = 0; j < d * d; j++)
+				O[j] = 0;
+			for (integer j = 0; j < d; j++)
+				O[j + j * d] = 1;
+		}
+
+		Manifold *Domain = NewElasticCurvesManifold(n, d);
+		ElasticCurvesVariable InitialX(n, d);
+		double *Xptr = InitialX.ObtainWriteEntireData();
+
+		// l = sqrt(gamma'), the rotation is the identity and the shift is the rest of the shift of Xinit
+		if (isclosed)
+			GradientPeriod(Xinit, n, 1.0 / (n - 1), Xptr);
+		else
+			Gradient(Xinit, n, 1.0 / (n - 1), Xptr);
+		for (integer j = 0; j < n; j++)
+		{
+			Xptr[j] = (Xptr[j] > 0) ? sqrt(Xptr[j]) : 0;
+		}
+		for (integer j = 0; j < d; j++)
+		{
+			Xptr[n + j + j * d] = 1;
+			for (integer k = j + 1; k < d; k++)
+			{
+				Xptr[n + k + j * d] = 0;
+				Xptr[n + j + k * d] = 0;
+			}
+		}
+		Xptr[n + d * d] = shift;
+
+		bool result = ElasticCurvesROSolve(q1, Rotq2shift, O, d, n, w, rotated, isclosed, ms, solverstr, Domain, &InitialX, O2, Xs,
+			fopt, telemetry, &finit, q2coefs, cache);
+		delete Domain;
+		return result;
+	};
+
+	bool ElasticCurvesROSolve(double *q1, double *Rotq2shift, const double *O, integer d, integer n, double w, bool rotated,
+		bool isclosed, integer ms, std::string solverstr, Manifold *Domain, Variable *InitialX, double *O2,
+		double *Xs, double &fopt, SolverTelemetry *telemetry, double *finit, const double *q2coefs, Solvers **cache)
+	{
+		Solvers *solver = (cache == nullptr) ? nullptr : *cache;
+		ElasticCurvesRO *ECRO = nullptr;
+		if (isclosed && q2coefs != nullptr)
+			ECRO = new ElasticCurvesRO(q1, q2coefs, ms, (rotated) ? O : nullptr, d, n, w, rotated);
+		else
+			ECRO = new ElasticCurvesRO(q1, Rotq2shift, d, n, w, rotated, isclosed);
+		ECRO->SetDomain(Domain);
+
+		char *transn = const_cast<char *> ("n"), *transt = const_cast<char *> ("t");
+		double one = 1, zero = 0;
+		integer dd = d * d, inc = 1;
+
+		// if a Riemannian method is used, then Xinitial is the initial iterate and a method is used.
+		// A cached solver of a previous start is reset instead of constructed. If the domain does not match, the cached
+		// solver is not reset and still refers to the deleted problem of the previous start, so a new one is constructed.
+		if (solver != nullptr && !solver->Reset(ECRO, InitialX))
+		{
+			delete solver;
+			solver = nullptr;
+			*cache = nullptr;
+		}
+		if (solver == nullptr)
+		{
+			if (solverstr == "RBFGS")
+			{
+				solver = new RBFGS(ECRO, InitialX);
+				dynamic_cast<SolversLS *> (solver)->Initstepsize = 0.001;
+			}
+			else
+			if (solverstr == "LRBFGS")
+			{
+				solver = new LRBFGS(ECRO, InitialX);
+				dynamic_cast<SolversLS *> (solver)->Initstepsize = 0.001;
+			}
+			else
+			if (solverstr == "RCG")
+			{
+				solver = new RCG(ECRO, InitialX);
+				dynamic_cast<SolversLS *> (solver)->Initstepsize = 0.001;
+			}
+			else
+			if (solverstr == "RSD")
+			{
+				solver = new RSD(ECRO, InitialX);
+				dynamic_cast<SolversLS *> (solver)->Initstepsize = 0.001;
+			}
+			else
+			if (solverstr == "RTRSR1")
+			{
+				solver = new RTRSR1(ECRO, InitialX);
+				dynamic_cast<SolversTR *> (solver)->kappa = 0.1;
+				dynamic_cast<SolversTR *> (solver)->theta = 1.0;
+			}
+			else
+			if (solverstr == "LRTRSR1")
+			{
+				solver = new LRTRSR1(ECRO, InitialX);
+				dynamic_cast<SolversTR *> (solver)->kappa = 0.1;
+				dynamic_cast<SolversTR *> (solver)->theta = 1.0;
+			}
+			else
+			if (solverstr == "RTRSD")
+			{
+				solver = new RTRSD(ECRO, InitialX);
+			}
+			else
+			{
+				fopt = 1000;
+				delete ECRO;
+				return false;
+			}
+			solver->Max_Iteration = 500;
+			solver->Min_Iteration = 10;
+			solver->Debug = NOOUTPUT; //--FINALRESULT;//--NOOUTPUT; //ITERRESULT
+			solver->Stop_Criterion = FUN_REL;
+			solver->Tolerance = 1e-3;
+		}
+		solver->SetTelemetry(telemetry);
+		solver->Run();
+		ECRO->w = 0;
+		fopt = ECRO->f(const_cast<Element *> (solver->GetXopt()));
+		if (finit != nullptr)
+			*finit = ECRO->f(InitialX);
+		// printf("%s func:%g, num of iter:%d\n", solverstr.c_str(), fopt, solver->GetIter());
+
+		// Xs <- Xopt, then turn l into gamma = int_0^t l^2 and compose the rotation with O
+		const double *Xoptptr = solver->GetXopt()->ObtainReadData();
+		integer sizex = n + d * d + 1;
+		dcopy_(&sizex, const_cast<double *> (Xoptptr), &inc, Xs, &inc);
+		for (integer j = 0; j < n; j++)
+		{
+			Xs[j] *= Xs[j];
+		}
+		double tmp1 = Xs[0], tmp2 = 0;
+		Xs[0] = 0;
+		for (integer j = 1; j < n; j++)
+		{
+			tmp2 = Xs[j];
+			Xs[j] = Xs[j - 1] + (tmp1 + tmp2) / 2 / (n - 1);
+			tmp1 = tmp2;
+		}
+		// The cost compares O_s q1 with O q2, so the rotation applied to C2 is O_s^T O with O_s the rotation of Xopt.
+		// O2 = reshape(Xs(n : n + d * d - 1), d, d)^T * O,
+		// details: http://www.netlib.org/lapack/explore-html/d7/d2b/dgemm_8f.html
+		dgemm_(transt, transn, &d, &d, &d, &one, Xs + n, &d, const_cast<double *> (O), &d, &zero, O2, &d);
+		// Xs(n:n + d * d - 1) <- reshape(O2, d * d, 1)
+		// details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+		dcopy_(&dd, O2, &inc, Xs + n, &inc);
+
+		Xs[n + d * d] = Xs[n + d * d] + static_cast<double> (ms) / (n - 1);
+
+		if (cache != nullptr)
+			*cache = solver;
+		else
+			delete solver;
+		delete ECRO;
+		return true;
+	};
+
+	double ElasticCurvesROSeed(const double *C2, const double *optQ2, const double *q1, const double *q1s, integer d, integer n,
+		integer ns, bool rotated, bool isclosed, bool onlyDP, integer ms, double *work, const double *seed, double *keep)
+	{
+		double *C2shift = work;
+		double *q2shift = C2shift + d * n;
+		double *O = q2shift + d * n;
+		double *Rotq2shift = O + d * d;
+		double *RotC2shift = Rotq2shift + d * n;
+		double *DPgam = RotC2shift + d * n;
+		double *C2s = DPgam + n + 2 * d * d; // after O2 and O3
+		double *q2s = C2s + d * ns;
+		double *DPgams = q2s + d * ns; // ns
+
+		double E = 0;
+		integer inc = 1, dd = d * d;
+		seed = (onlyDP) ? nullptr : seed;
+
+		// printf("%d, ", ms);
+		// obtain initial reparameterization
+		ShiftC(C2, d, n, C2shift, ms);
+		if (optQ2 == nullptr)
+			CurveToQ(C2shift, d, n, q2shift, isclosed);
+		else
+			ShiftC(optQ2, d, n, q2shift, ms);
+
+		if (rotated)
+		{ // if rotation is considered, rotate C2.
+			if (seed != nullptr)
+				dcopy_(&dd, const_cast<double *> (seed + 1), &inc, O, &inc);
+			else
+				FindBestRotation(q1, q2shift, d, n, O);
+			// Rotq2shift <- q2shift * O^T
+			RotateCurve(q2shift, O, d, n, Rotq2shift);
+			// RotC2shift <- C2shift * O^T
+			RotateCurve(C2shift, O, d, n, RotC2shift);
+		}
+		else
+		{ // Otherwise, keep C2.
+			integer nd = n * d;
+			// Rotq2shift <- q2shift, details:http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+			dcopy_(&nd, q2shift, &inc, Rotq2shift, &inc);
+			// RotC2shift <- C2shift, details:http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+			dcopy_(&nd, C2shift, &inc, RotC2shift, &inc);
+			// O is the identity
+			for (integer j = 0; j < d * d; j++)
+				O[j] = 0;
+			for (integer j = 0; j < d; j++)
+				O[j + j * d] = 1;
+		}
+
+		if (seed != nullptr)
+		{ // the coarse gamma is given by the seed
+			E = seed[0];
+			ReSampleGamma(seed + 1 + dd, ns, DPgam, n);
+		}
+		else
+		if (!onlyDP)
+		{ // if use Riemannian method, use coarse points to represent C2 and compute the initial gamma.
+			GetCurveSmall(RotC2shift, C2s, d, n, ns, isclosed);
+			CurveToQ(C2s, d, ns, q2s, isclosed);
+			E = DynamicProgramming(q2s, q1s, d, ns, DPgams, isclosed, NUMSMALL);
+			ReSampleGamma(DPgams, ns, DPgam, n);
+			if (keep != nullptr)
+			{
+				keep[0] = E;
+				// keep(1 : d * d) <- O, keep(d * d + 1 : d * d + ns) <- DPgams,
+				// details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+				dcopy_(&dd, O, &inc, keep + 1, &inc);
+				dcopy_(&ns, DPgams, &inc, keep + 1 + dd, &inc);
+			}
+		}
+		else
+		{ // if only use DP, then use dense grid to compute gamma
+			E = DynamicProgramming(Rotq2shift, q1, d, n, DPgam, isclosed, NUMBIG);
+		}
+		return E;
 	};
 
 	double DynamicProgramming(const double *q1, const double *q2, integer d, integer n, double *gamma, bool isclosed, SLOPESTYPE Nbrstype)
@@ -694,6 +1123,13 @@ namespace ROPTLIB{
 			C[i] /= norm;
 	};
 
+	integer CoarseNumPoints(integer n, double TAC)
+	{
+		integer ns = static_cast<int> (static_cast<double> (n) / 3);
+		ns = (ns > 30) ? 30 : ns;
+		return ns + static_cast<int> (TAC / PI * 2.0);
+	};
+
 	double ComputeTotalAngle(const double *C, integer d, integer n)
 	{
 		double temp1, temp2, temp3, angle, total_theta = 0;
@@ -936,6 +1372,20 @@ namespace ROPTLIB{
 			}
 		}
 
+		// O maximizes trace(O^T M) over SO(d), which has a closed form for d = 2, 3
+		if (d == 2)
+		{
+			BestRotation2(M, O);
+			delete[] M;
+			return;
+		}
+		if (d == 3)
+		{
+			BestRotation3(M, O);
+			delete[] M;
+			return;
+		}
+
 		// compute SVD of M;
 		char *joba = const_cast<char *> ("A");
 		double *U = new double[2 * d * d + d];
@@ -1009,6 +1459,136 @@ namespace ROPTLIB{
 		delete[] U;
 	};
 
+	double BestRotation2(const double *M, double *O)
+	{
+		// trace(O^T M) = cos(t) (M11 + M22) + sin(t) (M21 - M12) for the rotation by the angle t
+		double a = M[0] + M[3], b = M[1] - M[2];
+		double r = sqrt(a * a + b * b);
+		if (O != nullptr)
+		{
+			double c = (r > 0) ? a / r : 1, s = (r > 0) ? b / r : 0;
+			O[0] = c; O[1] = s;
+			O[2] = -s; O[3] = c;
+		}
+		return r;
+	};
+
+	double BestRotation3(const double *M, double *O)
+	{
+		// trace(O^T M) = p^T K p for the rotation O given by the unit quaternion p = (w, x, y, z)
+		double K[16], V[16];
+		K[0] = M[0] + M[4] + M[8];
+		K[5] = M[0] - M[4] - M[8];
+		K[10] = -M[0] + M[4] - M[8];
+		K[15] = -M[0] - M[4] + M[8];
+		K[1] = K[4] = M[5] - M[7];
+		K[2] = K[8] = M[6] - M[2];
+		K[3] = K[12] = M[1] - M[3];
+		K[6] = K[9] = M[3] + M[1];
+		K[7] = K[13] = M[6] + M[2];
+		K[11] = K[14] = M[7] + M[5];
+		for (integer i = 0; i < 16; i++)
+			V[i] = (i % 5 == 0) ? 1 : 0;
+
+		// the cyclic Jacobi method: K <- J^T K J and V <- V J until K is diagonal
+		double total = 0;
+		for (integer i = 0; i < 16; i++)
+			total += K[i] * K[i];
+		for (integer sweep = 0; sweep < 30; sweep++)
+		{
+			double off = 0;
+			for (integer p = 0; p < 3; p++)
+				for (integer q = p + 1; q < 4; q++)
+					off += K[p + q * 4] * K[p + q * 4];
+			if (off <= 1e-32 * total)
+				break;
+			for (integer p = 0; p < 3; p++)
+			{
+				for (integer q = p + 1; q < 4; q++)
+				{
+					double kpq = K[p + q * 4];
+					if (kpq == 0)
+						continue;
+					double theta = (K[q + q * 4] - K[p + p * 4]) / (2 * kpq);
+					double t = ((theta >= 0) ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1));
+					double c = 1.0 / sqrt(t * t + 1), s = t * c;
+					for (integer k = 0; k < 4; k++)
+					{
+						double kp = K[k + p * 4], kq = K[k + q * 4];
+						K[k + p * 4] = c * kp - s * kq;
+						K[k + q * 4] = s * kp + c * kq;
+					}
+					for (integer k = 0; k < 4; k++)
+					{
+						double kp = K[p + k * 4], kq = K[q + k * 4];
+						K[p + k * 4] = c * kp - s * kq;
+						K[q + k * 4] = s * kp + c * kq;
+					}
+					for (integer k = 0; k < 4; k++)
+					{
+						double vp = V[k + p * 4], vq = V[k + q * 4];
+						V[k + p * 4] = c * vp - s * vq;
+						V[k + q * 4] = s * vp + c * vq;
+					}
+				}
+			}
+		}
+
+		// the eigenvector of the largest eigenvalue is the optimal quaternion
+		integer imax = 0;
+		for (integer i = 1; i < 4; i++)
+		{
+			if (K[i + i * 4] > K[imax + imax * 4])
+				imax = i;
+		}
+		if (O != nullptr)
+		{
+			const double *p = V + imax * 4;
+			double w = p[0], x = p[1], y = p[2], z = p[3];
+			double np2 = w * w + x * x + y * y + z * z;
+			w /= sqrt(np2); x /= sqrt(np2); y /= sqrt(np2); z /= sqrt(np2);
+			O[0] = w * w + x * x - y * y - z * z;
+			O[1] = 2 * (x * y + w * z);
+			O[2] = 2 * (x * z - w * y);
+			O[3] = 2 * (x * y - w * z);
+			O[4] = w * w - x * x + y * y - z * z;
+			O[5] = 2 * (y * z + w * x);
+			O[6] = 2 * (x * z + w * y);
+			O[7] = 2 * (y * z - w * x);
+			O[8] = w * w - x * x - y * y + z * z;
+		}
+		return K[imax + imax * 4];
+	};
+
+	void RotateCurve(const double *C, const double *O, integer d, integer n, double *result)
+	{
+		if (d == 2)
+		{
+			for (integer i = 0; i < n; i++)
+			{
+				double c0 = C[i], c1 = C[i + n];
+				result[i] = O[0] * c0 + O[2] * c1;
+				result[i + n] = O[1] * c0 + O[3] * c1;
+			}
+			return;
+		}
+		if (d == 3)
+		{
+			for (integer i = 0; i < n; i++)
+			{
+				double c0 = C[i], c1 = C[i + n], c2 = C[i + 2 * n];
+				result[i] = O[0] * c0 + O[3] * c1 + O[6] * c2;
+				result[i + n] = O[1] * c0 + O[4] * c1 + O[7] * c2;
+				result[i + 2 * n] = O[2] * c0 + O[5] * c1 + O[8] * c2;
+			}
+			return;
+		}
+		char *transn = const_cast<char *> ("n"), *transt = const_cast<char *> ("t");
+		double one = 1, zero = 0;
+		// result = C * O^T, details: http://www.netlib.org/lapack/explore-html/d7/d2b/dgemm_8f.html
+		dgemm_(transn, transt, &n, &d, &d, &one, const_cast<double *> (C), &n, const_cast<double *> (O), &d, &zero, result, &n);
+	};
+
 	void GetCurveSmall(const double *C, double *Cs, integer d, integer n, integer ns, bool isclosed)
 	{
 		double *coefs;
@@ -1095,4 +1675,206 @@ namespace ROPTLIB{
 		for (i = 1; i < n - 1; i++)
 			grad[i] = (DPgam[i + 1] - DPgam[i - 1]) / 2 / h;
 	};
+
+	void ShiftRotationScores(const double *q1, const double *q2, integer d, integer n, bool rotated, double *E)
+	{
+		integer N = n - 1, dd = d * d;
+		// corr(m, i, j) = sum_k q1_i(k) q2_j(k + m mod N), i.e., M_m = q1^T G q2(. + m) up to the factor 1 / N.
+		double *corr = new double[dd * N + 2 * dd];
+		double *M = corr + dd * N;
+		double *M2 = M + dd;
+
+#ifdef ROPTLIB_WITH_FFTW
+		// corr(:, i, j) = ifft(conj(fft(q1_i)) .* fft(q2_j)); the real transforms keep N / 2 + 1 coefficients.
+		integer Nc = N / 2 + 1;
+		double *in = static_cast<double *> (fftw_malloc(sizeof(double) * N));
+		fftw_complex *F = static_cast<fftw_complex *> (fftw_malloc(sizeof(fftw_complex) * (2 * d + 1) * Nc));
+		fftw_complex *F1 = F, *F2 = F + d * Nc, *P = F + 2 * d * Nc;
+		fftw_plan pr2c, pc2r;
+		// the planner is not thread-safe
+#ifdef _OPENMP
+#pragma omp critical (ROPTLIB_FFTW_PLANNER)
+#endif
+		{
+			pr2c = fftw_plan_dft_r2c_1d(static_cast<int> (N), in, P, FFTW_ESTIMATE);
+			pc2r = fftw_plan_dft_c2r_1d(static_cast<int> (N), P, in, FFTW_ESTIMATE);
+		}
+		for (integer i = 0; i < d; i++)
+		{
+			for (integer k = 0; k < N; k++)
+				in[k] = q1[k + i * n];
+			fftw_execute_dft_r2c(pr2c, in, F1 + i * Nc);
+			for (integer k = 0; k < N; k++)
+				in[k] = q2[k + i * n];
+			fftw_execute_dft_r2c(pr2c, in, F2 + i * Nc);
+		}
+		for (integer i = 0; i < d; i++)
+		{
+			for (integer j = 0; j < d; j++)
+			{
+				for (integer k = 0; k < Nc; k++)
+				{
+					P[k][0] = F1[k + i * Nc][0] * F2[k + j * Nc][0] + F1[k + i * Nc][1] * F2[k + j * Nc][1];
+					P[k][1] = F1[k + i * Nc][0] * F2[k + j * Nc][1] - F1[k + i * Nc][1] * F2[k + j * Nc][0];
+				}
+				// the inverse transform of FFTW is not normalized
+				fftw_execute_dft_c2r(pc2r, P, in);
+				for (integer m = 0; m < N; m++)
+					corr[i + j * d + m * dd] = in[m] / N;
+			}
+		}
+#ifdef _OPENMP
+#pragma omp critical (ROPTLIB_FFTW_PLANNER)
+#endif
+		{
+			fftw_destroy_plan(pr2c);
+			fftw_destroy_plan(pc2r);
+		}
+		fftw_free(in);
+		fftw_free(F);
+#else
+		// without FFTW the correlations are summed directly, O(N^2 d^2)
+		for (integer m = 0; m < N; m++)
+		{
+			for (integer i = 0; i < d; i++)
+			{
+				for (integer j = 0; j < d; j++)
+				{
+					double tmp = 0;
+					for (integer k = 0; k < N - m; k++)
+						tmp += q1[k + i * n] * q2[k + m + j * n];
+					for (integer k = N - m; k < N; k++)
+						tmp += q1[k + i * n] * q2[k + m - N + j * n];
+					corr[i + j * d + m * dd] = tmp;
+				}
+			}
+		}
+#endif
+
+		double nq = 0;
+		for (integer i = 0; i < d * n; i++)
+		{
+			if (i % n != N)
+				nq += q1[i] * q1[i] + q2[i] * q2[i];
+		}
+
+		// singular values of M_m, and the workspace for them
+		char *jobn = const_cast<char *> ("N");
+		double *S = nullptr, *work = nullptr;
+		integer *IPIV = nullptr;
+		integer lwork = -1, info;
+		if (rotated && d > 3)
+		{
+			double workoptsize;
+			S = new double[d];
+			IPIV = new integer[d];
+			dgesvd_(jobn, jobn, &d, &d, M, &d, S, nullptr, &d, nullptr, &d, &workoptsize, &lwork, &info);
+			lwork = static_cast<integer> (workoptsize);
+			work = new double[lwork];
+		}
+
+		for (integer m = 0; m < N; m++)
+		{
+			double *Mm = corr + m * dd, s = 0;
+			if (!rotated)
+			{ // <q1, q2(. + m)>
+				for (integer i = 0; i < d; i++)
+					s += Mm[i + i * d];
+			}
+			else
+			if (d == 2)
+			{ // max over the rotation angle t of cos(t) (M11 + M22) + sin(t) (M21 - M12)
+				s = BestRotation2(Mm, nullptr);
+			}
+			else
+			if (d == 3)
+			{ // the largest eigenvalue of Horn's quaternion matrix
+				s = BestRotation3(Mm, nullptr);
+			}
+			else
+			{ // max_{O in SO(d)} trace(O^T M_m): the sum of the singular values, the smallest one negated if det(M_m) < 0
+				for (integer i = 0; i < dd; i++)
+				{
+					M[i] = Mm[i];
+					M2[i] = Mm[i];
+				}
+				// details: http://www.netlib.org/lapack/explore-html/d8/d2d/dgesvd_8f.html
+				dgesvd_(jobn, jobn, &d, &d, M, &d, S, nullptr, &d, nullptr, &d, work, &lwork, &info);
+				if (info != 0)
+				{
+					printf("Error:singular value decomposition failed!\n");
+				}
+				// details:http://www.netlib.org/lapack/explore-html/d3/d6a/dgetrf_8f.html
+				dgetrf_(&d, &d, M2, &d, IPIV, &info);
+				double det = 1;
+				for (integer i = 0; i < d; i++)
+					det *= (IPIV[i] != i + 1) ? -M2[i + i * d] : M2[i + i * d];
+				for (integer i = 0; i < d; i++)
+					s += S[i];
+				if (det < 0)
+					s -= 2 * S[d - 1];
+			}
+			E[m] = (nq - 2 * s) / N;
+		}
+
+		if (S != nullptr)
+		{
+			delete[] S;
+			delete[] IPIV;
+			delete[] work;
+		}
+		delete[] corr;
+	};
+
+	void FindSeedsByScores(const double *E, integer n, integer numseeds, integer minSkip, integer *ms, integer &lms)
+	{
+		integer N = n - 1;
+		integer *cand = new integer[N];
+		integer ncand = 0;
+		// local minima of the circular sequence E
+		for (integer m = 0; m < N; m++)
+		{
+			double Ep = E[(m + N - 1) % N], En = E[(m + 1) % N];
+			if (E[m] <= Ep && E[m] < En)
+			{
+				cand[ncand] = m;
+				ncand++;
+			}
+		}
+		if (ncand == 0)
+		{ // E is constant
+			cand[0] = 0;
+			ncand = 1;
+		}
+
+		// take the lowest minima first, skipping those within minSkip of a chosen one
+		lms = 0;
+		while (lms < numseeds)
+		{
+			integer best = -1;
+			for (integer k = 0; k < ncand; k++)
+			{
+				if (cand[k] >= 0 && (best < 0 || E[cand[k]] < E[cand[best]]))
+					best = k;
+			}
+			if (best < 0)
+				break;
+			integer m = cand[best];
+			cand[best] = -1;
+			bool isfar = true;
+			for (integer i = 0; i < lms; i++)
+			{
+				integer dist = (m > ms[i]) ? m - ms[i] : ms[i] - m;
+				dist = (dist < N - dist) ? dist : N - dist;
+				if (dist < minSkip)
+					isfar = false;
+			}
+			if (isfar)
+			{
+				ms[lms] = m;
+				lms++;
+			}
+		}
+		delete[] cand;
+	};
 }; /*end of ROPTLIB namespace*/
@@ -0,0 +1,699 @@
+
+#include "ElasticCurvesManifold.h"
+
+/*The length of the workspace on the stack for the d x d matrices, which is enough for four of them if d <= 3*/
+#define ECMSTACKLENGTH 36
+
+/*Define the namespace*/
+namespace ROPTLIB{
+
+	template <integer D>
+	ElasticCurvesManifold<D>::ElasticCurvesManifold(integer inn, integer ind)
+	{
+		// public parameter
+		HasHHR = false;
+
+		// The parameters of the components are fixed, see the header.
+		IsIntrApproach = true;
+		UpdBetaAlone = false;
+
+		// Status of locking condition
+		HasLockCon = false;
+
+		// Fixed parameters
+		n = inn;
+		d = (D > 0) ? D : ind;
+		if (D > 0 && ind != D)
+			printf("Warning: ElasticCurvesManifold<%d> is used for the dimension %d!\n", static_cast<int> (D), static_cast<int> (ind));
+		ExtrinsicDim = n + d * d + 1;
+		IntrinsicDim = n - 1 + d * (d - 1) / 2 + 1;
+		name.assign("ElasticCurvesManifold");
+		slotxdydn2 = Element::RegisterTempSlot("xdydn2");
+
+		EMPTYEXTR = new ElasticCurvesVector(n + d * d + 1);
+		EMPTYINTR = new ElasticCurvesVector(n + d * (d - 1) / 2 + 1);
+	};
+
+	template <integer D>
+	ElasticCurvesManifold<D>::~ElasticCurvesManifold(void)
+	{
+		delete EMPTYEXTR;
+		delete EMPTYINTR;
+	};
+
+	template <integer D>
+	double ElasticCurvesManifold<D>::TrapezoidDot(const double *a, const double *b) const
+	{
+		integer inc = 1, N = n;
+		// The interior points have weight 1 and the two end points 1/2.
+		// output a^T b, details: http://www.netlib.org/lapack/explore-html/d5/df6/ddot_8f.html
+		double result = ddot_(&N, const_cast<double *> (a), &inc, const_cast<double *> (b), &inc);
+		result -= (a[0] * b[0] + a[n - 1] * b[n - 1]) / 2;
+		return result / (n - 1);
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::MetricAxpy(double scalar, const double *u, const double *v, const double *w, const double *z, double *result) const
+	{
+		double coef = scalar * TrapezoidDot(u, v);
+		// the update is elementwise, so result may alias any of the inputs
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for (integer i = 0; i < n; i++)
+			result[i] = z[i] + coef * w[i];
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::RotIntr(const double *O, const double *E, double *w) const
+	{
+		const integer p = Dim();
+		double r2 = sqrt(2.0);
+		integer idx = 0;
+		for (integer i = 0; i < p; i++)
+		{
+			for (integer j = i + 1; j < p; j++)
+			{
+				// (O^T E)_{ji} - (O^T E)_{ij}
+				double a = 0;
+				for (integer k = 0; k < p; k++)
+					a += O[k + j * p] * E[k + i * p] - O[k + i * p] * E[k + j * p];
+				w[idx] = r2 * a / 2;
+				idx++;
+			}
+		}
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::RotExtr(const double *O, const double *w, double *E) const
+	{
+		const integer p = Dim();
+		double r2 = sqrt(2.0);
+		for (integer k = 0; k < p * p; k++)
+			E[k] = 0;
+		// E(:, i) += Omega_{ji} O(:, j) and E(:, j) += Omega_{ij} O(:, i) with Omega_{ji} = -Omega_{ij} = w / sqrt(2)
+		integer idx = 0;
+		for (integer i = 0; i < p; i++)
+		{
+			for (integer j = i + 1; j < p; j++)
+			{
+				double a = w[idx] / r2;
+				for (integer k = 0; k < p; k++)
+				{
+					E[k + i * p] += a * O[k + j * p];
+					E[k + j * p] -= a * O[k + i * p];
+				}
+				idx++;
+			}
+		}
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::RotProjection(const double *O, const double *V, double *R, double *S) const
+	{
+		const integer p = Dim();
+		// S = sym(O^T V)
+		for (integer i = 0; i < p; i++)
+		{
+			for (integer j = i; j < p; j++)
+			{
+				double a = 0;
+				for (integer k = 0; k < p; k++)
+					a += O[k + i * p] * V[k + j * p] + O[k + j * p] * V[k + i * p];
+				S[i + j * p] = a / 2;
+				S[j + i * p] = a / 2;
+			}
+		}
+		// R = V - O S, entry (k, j) only reads V(k, j)
+		for (integer j = 0; j < p; j++)
+		{
+			for (integer k = 0; k < p; k++)
+			{
+				double a = V[k + j * p];
+				for (integer i = 0; i < p; i++)
+					a -= O[k + i * p] * S[i + j * p];
+				R[k + j * p] = a;
+			}
+		}
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::RotQf(double *X) const
+	{
+		const integer p = Dim();
+		// modified Gram-Schmidt process, which gives the Q factor with the positive diagonal of R
+		for (integer j = 0; j < p; j++)
+		{
+			for (integer k = 0; k < j; k++)
+			{
+				double r = 0;
+				for (integer i = 0; i < p; i++)
+					r += X[i + k * p] * X[i + j * p];
+				for (integer i = 0; i < p; i++)
+					X[i + j * p] -= r * X[i + k * p];
+			}
+			double norm = 0;
+			for (integer i = 0; i < p; i++)
+				norm += X[i + j * p] * X[i + j * p];
+			norm = 1.0 / sqrt(norm);
+			for (integer i = 0; i < p; i++)
+				X[i + j * p] *= norm;
+		}
+	};
+
+	template <integer D>
+	double ElasticCurvesManifold<D>::Metric(Variable *x, Vector *etax, Vector *xix) const
+	{
+		const double *etaxTV = etax->ObtainReadData();
+		const double *xixTV = xix->ObtainReadData();
+		double result = TrapezoidDot(etaxTV, xixTV);
+		integer length = etax->Getlength();
+		for (integer i = n; i < length; i++)
+			result += etaxTV[i] * xixTV[i];
+		return result;
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::Projection(Variable *x, Vector *v, Vector *result) const
+	{
+		if (IsIntrApproach)
+			IntrProjection(x, v, result);
+		else
+			ExtrProjection(x, v, result);
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::Retraction(Variable *x, Vector *etax, Variable *result, double stepsize) const
+	{
+		const integer p = Dim();
+		const double *xl = x->ObtainReadData();
+		const double *etaxTV = etax->ObtainReadData();
+		integer lengthO = etax->Getlength() - n - 1;
+		double *resultTV = result->ObtainWriteEntireData();
+
+		// l: exponential mapping, the metrics of x and etax in one pass
+		double ee = (etaxTV[0] * etaxTV[0] + etaxTV[n - 1] * etaxTV[n - 1]) / 2;
+		double xe = (xl[0] * etaxTV[0] + xl[n - 1] * etaxTV[n - 1]) / 2;
+		double xx = (xl[0] * xl[0] + xl[n - 1] * xl[n - 1]) / 2;
+#ifdef _OPENMP
+#pragma omp simd reduction(+:ee, xe, xx)
+#endif
+		for (integer i = 1; i < n - 1; i++)
+		{
+			ee += etaxTV[i] * etaxTV[i];
+			xe += xl[i] * etaxTV[i];
+			xx += xl[i] * xl[i];
+		}
+		ee /= (n - 1);
+		xe /= (n - 1);
+		xx /= (n - 1);
+
+		double norm = sqrt(ee);
+		double a = cos(norm), b = (norm < std::numeric_limits<double>::epsilon()) ? 0 : sin(norm) / norm;
+		double scale = 1.0 / sqrt(a * a * xx + 2 * a * b * xe + b * b * ee);
+		a *= scale;
+		b *= scale;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for (integer i = 0; i < n; i++)
+			resultTV[i] = a * xl[i] + b * etaxTV[i];
+
+		// O: qf(O + etax), where etax = O * Omega in the intrinsic representation
+		const double *O = xl + n;
+		double *resultO = resultTV + n;
+		if (lengthO == p * p)
+		{
+			for (integer k = 0; k < p * p; k++)
+				resultO[k] = O[k] + etaxTV[n + k];
+		}
+		else
+		{
+			RotExtr(O, etaxTV + n, resultO);
+			for (integer k = 0; k < p * p; k++)
+				resultO[k] += O[k];
+		}
+		RotQf(resultO);
+
+		// m: addition
+		resultTV[n + p * p] = xl[n + p * p] + etaxTV[n + lengthO];
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::coTangentVector(Variable *x, Vector *etax, Variable *y, Vector *xiy, Vector *result) const
+	{
+		xiy->CopyTo(result);
+		printf("The cotangent vector has not been implemented!\n");
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::DiffRetraction(Variable *x, Vector *etax, Variable *y, Vector *xix, Vector *result, bool IsEtaXiSameDir) const
+	{
+		const integer p = Dim();
+		integer dd = p * p;
+		double stackspace[ECMSTACKLENGTH];
+		double *E = (4 * dd <= ECMSTACKLENGTH) ? stackspace : new double[4 * dd];
+		double *Z = E + dd, *W = Z + dd, *R = W + dd;
+
+		Vector *resultTemp = (xix == result) ? result->ConstructEmpty() : result;
+		const double *O = x->ObtainReadData() + n;
+		const double *Y = y->ObtainReadData() + n;
+		const double *etaxTV = etax->ObtainReadData();
+		const double *xixTV = xix->ObtainReadData();
+		double *resultTV = resultTemp->ObtainWriteEntireData();
+		bool intr = (etax->Getlength() != n + dd + 1);
+		integer lengthO = (intr) ? p * (p - 1) / 2 : dd;
+
+		// l: parallel translation
+		if (IsEtaXiSameDir)
+		{
+			ObtainXdydn2(x, etax, y);
+			const SharedSpace *Sharedxdydn2 = etax->ObtainReadTempData(slotxdydn2);
+			MetricAxpy(-2.0, xixTV, y->ObtainReadData(), Sharedxdydn2->ObtainReadData(), xixTV, resultTV);
+		}
+		else
+		{
+			printf("Warning: The differentiated retraction has not been implemented!\n");
+			for (integer i = 0; i < n; i++)
+				resultTV[i] = xixTV[i];
+		}
+
+		// O: Dqf(O + E)[Z] = Y rho_skew(Y^T Z R^{-1}), where R = Y^T (O + E) is upper triangular
+		if (intr)
+		{
+			RotExtr(O, etaxTV + n, E);
+			RotExtr(O, xixTV + n, Z);
+		}
+		else
+		{
+			for (integer k = 0; k < dd; k++)
+			{
+				E[k] = etaxTV[n + k];
+				Z[k] = xixTV[n + k];
+			}
+		}
+		for (integer i = 0; i < p; i++)
+		{
+			for (integer j = i; j < p; j++)
+			{
+				double a = 0;
+				for (integer k = 0; k < p; k++)
+					a += Y[k + i * p] * (O[k + j * p] + E[k + j * p]);
+				R[i + j * p] = a;
+			}
+		}
+		// W = Z R^{-1} by forward substitution on the columns
+		for (integer j = 0; j < p; j++)
+		{
+			for (integer k = 0; k < p; k++)
+			{
+				double a = Z[k + j * p];
+				for (integer i = 0; i < j; i++)
+					a -= W[k + i * p] * R[i + j * p];
+				W[k + j * p] = a / R[j + j * p];
+			}
+		}
+		// E <- the strictly lower triangular part of Y^T W
+		for (integer i = 0; i < p; i++)
+		{
+			for (integer j = 0; j < p; j++)
+			{
+				double a = 0;
+				if (j > i)
+				{
+					for (integer k = 0; k < p; k++)
+						a += Y[k + j * p] * W[k + i * p];
+				}
+				E[j + i * p] = a;
+			}
+		}
+		if (intr)
+		{ // the intrinsic representation of Y rho_skew at Y is sqrt(2) times the strictly lower part
+			double r2 = sqrt(2.0);
+			integer idx = 0;
+			for (integer i = 0; i < p; i++)
+			{
+				for (integer j = i + 1; j < p; j++)
+				{
+					resultTV[n + idx] = r2 * E[j + i * p];
+					idx++;
+				}
+			}
+		}
+		else
+		{ // result = Y (E - E^T)
+			for (integer j = 0; j < p; j++)
+			{
+				for (integer k = 0; k < p; k++)
+				{
+					double a = 0;
+					for (integer i = 0; i < p; i++)
+						a += Y[k + i * p] * (E[i + j * p] - E[j + i * p]);
+					resultTV[n + k + j * p] = a;
+				}
+			}
+		}
+
+		// m: identity
+		resultTV[n + lengthO] = xixTV[n + lengthO];
+
+		if (resultTemp != result)
+		{
+			resultTemp->CopyTo(result);
+			delete resultTemp;
+		}
+		if (E != stackspace)
+			delete[] E;
+
+		if (IsEtaXiSameDir)
+		{
+			double EtatoXi = sqrt(Metric(x, etax, etax) / Metric(x, xix, xix));
+			SharedSpace *beta = new SharedSpace(1, 1);
+			double *betav = beta->ObtainWriteEntireData();
+			betav[0] = sqrt(Metric(x, etax, etax) / Metric(x, result, result)) / EtatoXi;
+			etax->AddToTempData("beta", beta);
+
+			Vector *TReta = result->ConstructEmpty();
+			result->CopyTo(TReta);
+			ScaleTimesVector(x, betav[0] * EtatoXi, TReta, TReta);
+			SharedSpace *SharedTReta = new SharedSpace(TReta);
+			etax->AddToTempData("betaTReta", SharedTReta);
+		}
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::ObtainXdydn2(Variable *x, Vector *etax, Variable *y) const
+	{
+		if (etax->TempDataExist(slotxdydn2))
+			return;
+		SharedSpace *Sharedxdy = new SharedSpace(1, n);
+		const double *xl = x->ObtainReadData();
+		const double *yl = y->ObtainReadData();
+		double *xdyTV = Sharedxdy->ObtainWriteEntireData();
+		// xdy = x + y and its squared norm in one pass, then the scaling
+		double nrm2 = 0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+:nrm2)
+#endif
+		for (integer i = 1; i < n - 1; i++)
+		{
+			xdyTV[i] = xl[i] + yl[i];
+			nrm2 += xdyTV[i] * xdyTV[i];
+		}
+		xdyTV[0] = xl[0] + yl[0];
+		xdyTV[n - 1] = xl[n - 1] + yl[n - 1];
+		nrm2 = (nrm2 + (xdyTV[0] * xdyTV[0] + xdyTV[n - 1] * xdyTV[n - 1]) / 2) / (n - 1);
+		double scale = 1.0 / nrm2;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for (integer i = 0; i < n; i++)
+			xdyTV[i] *= scale;
+		etax->AddToTempData(slotxdydn2, Sharedxdy);
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::VectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xix, Vector *result) const
+	{
+		ObtainXdydn2(x, etax, y);
+		const SharedSpace *Sharedxdydn2 = etax->ObtainReadTempData(slotxdydn2);
+		const double *xixTV = xix->ObtainReadData();
+		integer length = xix->Getlength();
+		double *resultTV = result->ObtainWriteEntireData();
+		// l: result = xix - 2 g(xix, y) (x + y) / \|x + y\|^2, the other components are copied
+		MetricAxpy(-2.0, xixTV, y->ObtainReadData(), Sharedxdydn2->ObtainReadData(), xixTV, resultTV);
+		for (integer i = n; i < length; i++)
+			resultTV[i] = xixTV[i];
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::InverseVectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xiy, Vector *result) const
+	{
+		ObtainXdydn2(x, etax, y);
+		const SharedSpace *Sharedxdydn2 = etax->ObtainReadTempData(slotxdydn2);
+		const double *xiyTV = xiy->ObtainReadData();
+		integer length = xiy->Getlength();
+		double *resultTV = result->ObtainWriteEntireData();
+		// l: result = xiy - 2 g(xiy, x) (x + y) / \|x + y\|^2, the other components are copied
+		MetricAxpy(-2.0, xiyTV, x->ObtainReadData(), Sharedxdydn2->ObtainReadData(), xiyTV, resultTV);
+		for (integer i = n; i < length; i++)
+			resultTV[i] = xiyTV[i];
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::HInvTran(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, integer start, integer end, LinearOPE *result) const
+	{
+		ObtainXdydn2(x, etax, y);
+		const SharedSpace *Sharedxdydn2 = etax->ObtainReadTempData(slotxdydn2);
+		const double *xdydn2TV = Sharedxdydn2->ObtainReadData();
+		const double *xl = x->ObtainReadData();
+
+		integer ell = Hx->Getsize()[0];
+		integer length = n;
+		const double *M = Hx->ObtainReadData();
+		double *Hxpy = new double[ell + n];
+		double *xflatptr = Hxpy + ell;
+
+		char *transn = const_cast<char *> ("n");
+		double one = 1, zero = 0;
+		integer inc = 1, N = ell;
+		// Hxpy <- M(:, start : start + n - 1) * xdydn2TV,
+		// details: http://www.netlib.org/lapack/explore-html/dc/da8/dgemv_8f.html
+		dgemv_(transn, &N, &length, &one, const_cast<double *> (M + start * N), &N, const_cast<double *> (xdydn2TV), &inc, &zero, Hxpy, &inc);
+
+		double scalar = -2.0;
+		Hx->CopyTo(result);
+
+		for (integer i = 0; i < n; i++)
+			xflatptr[i] = xl[i] / (n - 1);
+		xflatptr[0] /= 2;
+		xflatptr[n - 1] /= 2;
+		double *resultL = result->ObtainWritePartialData();
+		// resultL(:, start : start + n - 1) <- scalar * Hxpy * xflatptr^T + resultL(:, start : start + n - 1)
+		// details: http://www.netlib.org/lapack/explore-html/dc/da8/dger_8f.html
+		dger_(&N, &length, &scalar, Hxpy, &inc, xflatptr, &inc, resultL + start * N, &N);
+		delete[] Hxpy;
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::TranH(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, integer start, integer end, LinearOPE *result) const
+	{
+		ObtainXdydn2(x, etax, y);
+		const SharedSpace *Sharedxdydn2 = etax->ObtainReadTempData(slotxdydn2);
+		const double *xdydn2TV = Sharedxdydn2->ObtainReadData();
+		const double *yl = y->ObtainReadData();
+
+		integer ell = Hx->Getsize()[0];
+		integer length = n;
+		const double *M = Hx->ObtainReadData();
+		double *Hty = new double[ell + n];
+		double *yflatptr = Hty + ell;
+
+		for (integer i = 0; i < n; i++)
+			yflatptr[i] = yl[i] / (n - 1);
+		yflatptr[0] /= 2;
+		yflatptr[n - 1] /= 2;
+
+		char *transt = const_cast<char *> ("t");
+		double one = 1, zero = 0;
+		integer inc = 1, N = ell;
+		// Hty <- M(start : start + n - 1, :)^T * yflatptr
+		// details: http://www.netlib.org/lapack/explore-html/dc/da8/dgemv_8f.html
+		dgemv_(transt, &length, &N, &one, const_cast<double *> (M + start), &N, yflatptr, &inc, &zero, Hty, &inc);
+
+		double scalar = -2.0;
+		Hx->CopyTo(result);
+		double *resultL = result->ObtainWritePartialData();
+		// resultL(start : start + n - 1, :) <- scalar * xdydn2TV * Hty^T + resultL(start : start + n - 1, :)
+		// details: http://www.netlib.org/lapack/explore-html/dc/da8/dger_8f.html
+		dger_(&length, &N, &scalar, const_cast<double *> (xdydn2TV), &inc, Hty, &inc, resultL + start, &N);
+		delete[] Hty;
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::TranHInvTran(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, LinearOPE *result) const
+	{
+		HInvTran(x, etax, y, Hx, 0, n, result);
+		TranH(x, etax, y, result, 0, n, result);
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::HaddScaledRank1OPE(Variable *x, LinearOPE *Hx, double scalar, Vector *etax, Vector *xix, LinearOPE *result) const
+	{
+		Vector *xixflat = xix->ConstructEmpty();
+		ObtainEtaxFlat(x, xix, xixflat);
+		Manifold::HaddScaledRank1OPE(x, Hx, scalar, etax, xixflat, result);
+		delete xixflat;
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::ObtainEtaxFlat(Variable *x, Vector *etax, Vector *etaxflat) const
+	{
+		const double *etaxTV = etax->ObtainReadData();
+		integer length = etax->Getlength();
+		double *etaxflatTV = (etax == etaxflat) ? etaxflat->ObtainWritePartialData() : etaxflat->ObtainWriteEntireData();
+		double intv = 1.0 / (n - 1);
+		if (etax == etaxflat)
+			etaxTV = etaxflatTV;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for (integer i = 0; i < n; i++)
+			etaxflatTV[i] = etaxTV[i] * intv;
+		etaxflatTV[0] /= 2;
+		etaxflatTV[n - 1] /= 2;
+		for (integer i = n; i < length; i++)
+			etaxflatTV[i] = etaxTV[i];
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::ObtainIntr(Variable *x, Vector *etax, Vector *result) const
+	{
+		const integer p = Dim();
+		const double *O = x->ObtainReadData() + n;
+		const double *etaxTV = etax->ObtainReadData();
+		double *resultTV = result->ObtainWriteEntireData();
+		integer inc = 1, N = n;
+		// resultTV(0 : n - 1) <- etaxTV(0 : n - 1), details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+		dcopy_(&N, const_cast<double *> (etaxTV), &inc, resultTV, &inc);
+		RotIntr(O, etaxTV + n, resultTV + n);
+		resultTV[n + p * (p - 1) / 2] = etaxTV[n + p * p];
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::ObtainExtr(Variable *x, Vector *intretax, Vector *result) const
+	{
+		const integer p = Dim();
+		const double *O = x->ObtainReadData() + n;
+		const double *intretaxTV = intretax->ObtainReadData();
+		double *resultTV = result->ObtainWriteEntireData();
+		integer inc = 1, N = n;
+		// resultTV(0 : n - 1) <- intretaxTV(0 : n - 1), details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+		dcopy_(&N, const_cast<double *> (intretaxTV), &inc, resultTV, &inc);
+		RotExtr(O, intretaxTV + n, resultTV + n);
+		resultTV[n + p * p] = intretaxTV[n + p * (p - 1) / 2];
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::IntrProjection(Variable *x, Vector *v, Vector *result) const
+	{
+		const double *xl = x->ObtainReadData();
+		const double *vl = v->ObtainReadData();
+		integer length = v->Getlength();
+		double *resultTV = (v == result) ? result->ObtainWritePartialData() : result->ObtainWriteEntireData();
+		if (v == result)
+			vl = resultTV;
+		// l: result = v - g(x, v) x, the other components are copied
+		MetricAxpy(-1.0, xl, vl, xl, vl, resultTV);
+		for (integer i = n; i < length; i++)
+			resultTV[i] = vl[i];
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::ExtrProjection(Variable *x, Vector *v, Vector *result) const
+	{
+		const integer p = Dim();
+		double stackspace[ECMSTACKLENGTH];
+		double *S = (p * p <= ECMSTACKLENGTH) ? stackspace : new double[p * p];
+		const double *xl = x->ObtainReadData();
+		const double *vl = v->ObtainReadData();
+		double *resultTV = (v == result) ? result->ObtainWritePartialData() : result->ObtainWriteEntireData();
+		if (v == result)
+			vl = resultTV;
+		// l: result = v - g(x, v) x, O: result = v - x sym(x^T v), m is copied
+		MetricAxpy(-1.0, xl, vl, xl, vl, resultTV);
+		RotProjection(xl + n, vl + n, resultTV + n, S);
+		resultTV[n + p * p] = vl[n + p * p];
+		if (S != stackspace)
+			delete[] S;
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::CheckParams(void) const
+	{
+		Manifold::CheckParams();
+		printf("%s PARAMETERS:\n", name.c_str());
+		printf("n             :%15d,\t", n);
+		printf("d             :%15d\n", d);
+		printf("Components    :L2Sphere(TRAPEZOID, L2SEXP, L2SPARALLELTRANSLATION) x OrthGroup(EUCLIDEAN, QF, PARALLELIZATION) x Euclidean\n");
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::EucGradToGrad(Variable *x, Vector *egf, Vector *gf, const Problem *prob) const
+	{
+		if (prob->GetUseHess())
+		{
+			Vector *segf = egf->ConstructEmpty();
+			segf->NewMemoryOnWrite(); // I don't remember the reason. It seems to be required.
+			egf->CopyTo(segf);
+			SharedSpace *Sharedegf = new SharedSpace(segf);
+			x->AddToTempData("EGrad", Sharedegf);
+		}
+		ExtrProjection(x, egf, gf);
+	};
+
+	template <integer D>
+	void ElasticCurvesManifold<D>::EucHvToHv(Variable *x, Vector *etax, Vector *exix, Vector* xix, const Problem *prob) const
+	{
+		const integer p = Dim();
+		double stackspace[ECMSTACKLENGTH];
+		double *S = (p * p <= ECMSTACKLENGTH) ? stackspace : new double[p * p];
+		const double *xptr = x->ObtainReadData();
+		const double *O = xptr + n;
+		const SharedSpace *Sharedegf = x->ObtainReadTempData("EGrad");
+		const double *egf = Sharedegf->GetSharedElement()->ObtainReadData();
+		const double *etaxptr = etax->ObtainReadData();
+		exix->CopyTo(xix);
+		double *xixptr = xix->ObtainWritePartialData();
+
+		// l: as in L2Sphere, xix = exix - 3 g(egf, x^3) / g(x^3, x^3) x^2 etax
+		double *xcubed = new double[n];
+		for (integer i = 0; i < n; i++)
+			xcubed[i] = xptr[i] * xptr[i] * xptr[i];
+		double a1 = TrapezoidDot(xcubed, xcubed);
+		double a2 = TrapezoidDot(egf, xcubed);
+		for (integer i = 0; i < n; i++)
+			xixptr[i] -= 3.0 * a2 / a1 * xptr[i] * xptr[i] * etaxptr[i];
+		delete[] xcubed;
+
+		// O: as in Stiefel, xix = exix - etax sym(x^T egf)
+		for (integer i = 0; i < p; i++)
+		{
+			for (integer j = i; j < p; j++)
+			{
+				double a = 0;
+				for (integer k = 0; k < p; k++)
+					a += O[k + i * p] * egf[n + k + j * p] + O[k + j * p] * egf[n + k + i * p];
+				S[i + j * p] = a / 2;
+				S[j + i * p] = a / 2;
+			}
+		}
+		for (integer j = 0; j < p; j++)
+		{
+			for (integer k = 0; k < p; k++)
+			{
+				for (integer i = 0; i < p; i++)
+					xixptr[n + k + j * p] -= etaxptr[n + k + i * p] * S[i + j * p];
+			}
+		}
+		if (S != stackspace)
+			delete[] S;
+		ExtrProjection(x, xix, xix);
+	};
+
+	Manifold *NewElasticCurvesManifold(integer n, integer d)
+	{
+		if (d == 1)
+			return new ElasticCurvesManifold<1>(n);
+		if (d == 2)
+			return new ElasticCurvesManifold<2>(n);
+		if (d == 3)
+			return new ElasticCurvesManifold<3>(n);
+		return new ElasticCurvesManifold<0>(n, d);
+	};
+
+	template class ElasticCurvesManifold<0>;
+	template class ElasticCurvesManifold<1>;
+	template class ElasticCurvesManifold<2>;
+	template class ElasticCurvesManifold<3>;
+}; /*end of ROPTLIB namespace*/
@@ -6,34 +6,101 @@ namespace ROPTLIB{
 
 	ElasticCurvesRO::ElasticCurvesRO(double *inq1, double *inq2, integer ind, integer inn, double inw, bool inrotated, bool inisclosed)
 	{
-		n = inn;
-		d = ind;
-		w = inw;
-		rotated = inrotated;
-		isclosed = inisclosed;
-		q1 = inq1;
-		q2_coefs = new double[4 * d * (n - 1) + 3 * d * (n - 1) + 2 * d * (n - 1)];
-		dq2_coefs = q2_coefs + 4 * d * (n - 1);
-		ddq2_coefs = dq2_coefs + 3 * d * (n - 1);
+		Initialization(inq1, ind, inn, inw, inrotated, inisclosed);
+		// the splines are computed per dimension and then interleaved per interval for the batch evaluation
+		double *coefs = new double[4 * d * (n - 1) + 3 * d * (n - 1) + 2 * d * (n - 1)];
 		if (isclosed)
 		{
 			for (integer i = 0; i < d; i++)
 			{
-				Spline::SplineUniformPeriodic(inq2 + i * n, n, 1.0 / (n - 1), q2_coefs + i * 4 * (n - 1));
+				Spline::SplineUniformPeriodic(inq2 + i * n, n, 1.0 / (n - 1), coefs + i * 4 * (n - 1));
 			}
 		}
 		else
 		{
 			for (integer i = 0; i < d; i++)
 			{
-				Spline::SplineUniformSlopes(inq2 + i * n, n, 1.0 / (n - 1), q2_coefs + i * 4 * (n - 1));
+				Spline::SplineUniformSlopes(inq2 + i * n, n, 1.0 / (n - 1), coefs + i * 4 * (n - 1));
+			}
+		}
+		SetCoefs(coefs);
+		delete[] coefs;
+	};
+
+	ElasticCurvesRO::ElasticCurvesRO(double *inq1, const double *inq2coefs, integer inms, const double *inO, integer ind, integer inn,
+		double inw, bool inrotated)
+	{
+		Initialization(inq1, ind, inn, inw, inrotated, true);
+		integer nn = n - 1;
+		integer m = inms % nn;
+		double *coefs = new double[4 * d * nn + 3 * d * nn + 2 * d * nn];
+		// interval i of the shifted data is interval i + m of the data, see ShiftC
+		for (integer j = 0; j < d; j++)
+		{
+			const double *coefsj = inq2coefs + j * 4 * nn;
+			double *scoefsj = coefs + j * 4 * nn;
+			for (integer k = 0; k < 4; k++)
+			{
+				for (integer i = 0; i < nn - m; i++)
+					scoefsj[k * nn + i] = coefsj[k * nn + i + m];
+				for (integer i = nn - m; i < nn; i++)
+					scoefsj[k * nn + i] = coefsj[k * nn + i + m - nn];
+			}
+		}
+		if (inO != nullptr)
+		{ // coefs of q2 * O^T, i.e., coefs(:, j) <- sum_k O(j, k) coefs(:, k), the derivative part is used as workspace
+			integer len = 4 * nn;
+			double *tmp = coefs + 4 * d * nn;
+			for (integer i = 0; i < len; i++)
+			{
+				for (integer j = 0; j < d; j++)
+				{
+					double v = 0;
+					for (integer k = 0; k < d; k++)
+						v += inO[j + k * d] * coefs[i + k * len];
+					tmp[j] = v;
+				}
+				for (integer j = 0; j < d; j++)
+					coefs[i + j * len] = tmp[j];
 			}
 		}
+		SetCoefs(coefs);
+		delete[] coefs;
+	};
+
+	void ElasticCurvesRO::Initialization(double *inq1, integer ind, integer inn, double inw, bool inrotated, bool inisclosed)
+	{
+		n = inn;
+		d = ind;
+		w = inw;
+		rotated = inrotated;
+		isclosed = inisclosed;
+		q1 = inq1;
+		slotw = Element::RegisterTempSlot("w");
+		slotq2g = Element::RegisterTempSlot("q2g");
+		slotgam = Element::RegisterTempSlot("gamma");
+		slotOq1mq2l = Element::RegisterTempSlot("Oq1md2l");
+		slotOq1 = Element::RegisterTempSlot("Oq1");
+		slotdq2g = Element::RegisterTempSlot("dq2g");
+		slotyy = Element::RegisterTempSlot("yy");
+		slotddq2g = Element::RegisterTempSlot("ddq2g");
+		q2_coefs = new double[4 * d * (n - 1) + 3 * d * (n - 1) + 2 * d * (n - 1)];
+		dq2_coefs = q2_coefs + 4 * d * (n - 1);
+		ddq2_coefs = dq2_coefs + 3 * d * (n - 1);
+	};
+
+	void ElasticCurvesRO::SetCoefs(double *coefs)
+	{
+		double *dcoefs = coefs + 4 * d * (n - 1);
+		double *ddcoefs = dcoefs + 3 * d * (n - 1);
 		for (integer i = 0; i < d; i++)
 		{
-			Spline::FirstDeri(q2_coefs + i * 4 * (n - 1), n, dq2_coefs + i * 3 * (n - 1));
-			Spline::SecondDeri(q2_coefs + i * 4 * (n - 1), n, ddq2_coefs + i * 2 * (n - 1));
+			Spline::FirstDeri(coefs + i * 4 * (n - 1), n, dcoefs + i * 3 * (n - 1));
+			Spline::SecondDeri(coefs + i * 4 * (n - 1), n, ddcoefs + i * 2 * (n - 1));
 		}
+		Spline::InterleaveUniform(coefs, n, d, 4, q2_coefs);
+		Spline::InterleaveUniform(dcoefs, n, d, 3, dq2_coefs);
+		Spline::InterleaveUniform(ddcoefs, n, d, 2, ddq2_coefs);
 	};
 
 	ElasticCurvesRO::~ElasticCurvesRO()
@@ -43,9 +110,36 @@ namespace ROPTLIB{
 
 	double ElasticCurvesRO::f(Variable *x) const
 	{
-		if (x->TempDataExist("w"))
+		return FuncEucGrad(x, nullptr);
+	};
+
+	double ElasticCurvesRO::FuncGrad(Variable *x, Vector *gf) const
+	{
+		// the same steps as Problem::Grad, with the Euclidean gradient computed together with the cost
+		if (!Domain->GetIsIntrinsic())
+		{
+			double result = FuncEucGrad(x, gf);
+			Domain->EucGradToGrad(x, gf, gf, this);
+			return result;
+		}
+		Vector *exgf = Domain->GetEMPTYEXTR()->ConstructEmpty();
+		double result = FuncEucGrad(x, exgf);
+		Domain->EucGradToGrad(x, exgf, exgf, this);
+		Domain->ObtainIntr(x, exgf, gf);
+		delete exgf;
+		return result;
+	};
+
+	bool ElasticCurvesRO::HasFuncGrad(void) const
+	{
+		return true;
+	};
+
+	double ElasticCurvesRO::FuncEucGrad(Variable *x, Vector *egf) const
+	{
+		if (x->TempDataExist(slotw))
 		{
-			const SharedSpace *Sharedw = x->ObtainReadTempData("w");
+			const SharedSpace *Sharedw = x->ObtainReadTempData(slotw);
 			const double *wptr = Sharedw->ObtainReadData();
 			w = wptr[0];
 		}
@@ -54,7 +148,7 @@ namespace ROPTLIB{
 			SharedSpace *Sharedw = new SharedSpace(1, 1);
 			double *wptr = Sharedw->ObtainWriteEntireData();
 			wptr[0] = w;
-			x->AddToTempData("w", Sharedw);
+			x->AddToTempData(slotw, Sharedw);
 		}
 		const double *l = x->ObtainReadData();
 		const double *O = l + n;
@@ -99,17 +193,22 @@ namespace ROPTLIB{
 				gamma[i] = (gamma[i] > 1) ? gamma[i] - 1 : gamma[i];
 			}
 		}
-		// obtain q2 \circ gamma
+		// obtain q2 \circ gamma, and q2' \circ gamma if the gradient is needed
 		SharedSpace * Sharedq2g = new SharedSpace(1, n * d);
 		double *q2g = Sharedq2g->ObtainWriteEntireData();
+		SharedSpace *Shareddq2g = nullptr;
+		double *dq2g = nullptr;
 		double intv = 1.0 / (n - 1);
 
-		for (integer i = 0; i < n; i++)
+		if (egf == nullptr)
 		{
-			for (integer j = 0; j < d; j++)
-			{
-				q2g[i + j * n] = Spline::ValSplineUniform(q2_coefs + j * 4 * (n - 1), n, intv, gamma[i]);
-			}
+			Spline::ValSplineUniformBatch(q2_coefs, n, d, intv, gamma, n, q2g);
+		}
+		else
+		{
+			Shareddq2g = new SharedSpace(1, n * d);
+			dq2g = Shareddq2g->ObtainWriteEntireData();
+			Spline::ValSplineAndFirstDeriUniformBatch(q2_coefs, n, d, intv, gamma, n, q2g, dq2g);
 		}
 		// obtain O q1
 		SharedSpace *SharedOq1 = nullptr;
@@ -125,41 +224,55 @@ namespace ROPTLIB{
 			dgemm_(transn, transt, &n, &d, &d, &one, q1, &n, const_cast<double *> (O), &d, &zero, Oq1, &n);
 		}
 
-		// Oq1 - q2 l(t)
+		// Oq1 - q2 l(t) and its squared norm at each sample, integrated by the trapezoidal rule.
+		// With the gradient, x, dy and the integrand of dm are accumulated in the same pass.
 		SharedSpace *SharedOq1mq2l = new SharedSpace(1, n * d);
 		double *Oq1mq2l = SharedOq1mq2l->ObtainWriteEntireData();
-		for (integer i = 0; i < n; i++)
+		double *xx = nullptr, *dyy = nullptr;
+		double dm0 = 0, tmpm = 0;
+		if (egf != nullptr)
 		{
-			for (integer j = 0; j < d; j++)
-			{
-				Oq1mq2l[i + j * n] = Oq1[i + j * n] - q2g[i + j * n] * l[i];
-			}
+			xx = MemoryPool::NewDoubles(2 * n);
+			dyy = xx + n;
 		}
 		double result = 0;
-		tmp = 0;
-		for (integer i = 0; i < d; i++)
-		{
-			tmp2 = Oq1mq2l[0 + i * n];
-			tmp += tmp2 * tmp2;
-		}
-		result = tmp / 2;
-		for (integer i = 1; i < n - 1; i++)
+		for (integer i = 0; i < n; i++)
 		{
 			tmp = 0;
 			for (integer j = 0; j < d; j++)
 			{
+				Oq1mq2l[i + j * n] = Oq1[i + j * n] - q2g[i + j * n] * l[i];
 				tmp2 = Oq1mq2l[i + j * n];
 				tmp += tmp2 * tmp2;
 			}
-			result += tmp;
-		}
-		tmp = 0;
-		for (integer j = 0; j < d; j++)
-		{
-			tmp2 = Oq1mq2l[n - 1 + n * j];
-			tmp += tmp2 * tmp2;
+			if (i == 0)
+				result = tmp / 2;
+			else
+			if (i == n - 1)
+				result += tmp / 2;
+			else
+				result += tmp;
+
+			if (egf != nullptr)
+			{
+				xx[i] = 0;
+				dyy[i] = 0;
+				tmpm = 0;
+				for (integer j = 0; j < d; j++)
+				{
+					xx[i] += Oq1mq2l[i + j * n] * q2g[i + j * n];
+					dyy[i] += Oq1mq2l[i + j * n] * l[i] * dq2g[i + j * n] * 2.0;
+					tmpm += Oq1mq2l[i + j * n] * l[i] * dq2g[i + j * n];
+				}
+				if (i == 0)
+					dm0 = tmpm / 2;
+				else
+				if (i == n - 1)
+					dm0 += tmpm / 2;
+				else
+					dm0 += tmpm;
+			}
 		}
-		result += tmp / 2;
 		result /= (n - 1);
 
 		// add penlty term
@@ -176,13 +289,36 @@ namespace ROPTLIB{
 		penlty *= w / (n - 1);
 		result += penlty;
 
+		if (egf != nullptr)
+		{
+			SharedSpace *Sharedyy = new SharedSpace(1, n);
+			double *yy = Sharedyy->ObtainWriteEntireData();
+			double *dl = egf->ObtainWriteEntireData();
+			double *dO = dl + n;
+			double *dm = dO + d * d;
+			EucGradFromSamples(l, q2g, xx, dyy, yy, dl, dO);
+			dm[0] = (isclosed) ? dm0 * (-2.0 / (n - 1)) : 0;
+
+			if (UseHess)
+			{
+				x->AddToTempData(slotdq2g, Shareddq2g);
+				x->AddToTempData(slotyy, Sharedyy);
+			}
+			else
+			{
+				delete Shareddq2g;
+				delete Sharedyy;
+			}
+			MemoryPool::DeleteDoubles(xx, 2 * n);
+		}
+
 		// attach data to x. the data can be used in gradient and hessian computation.
-		x->AddToTempData("q2g", Sharedq2g);
-		x->AddToTempData("gamma", Sharedgam);
-		x->AddToTempData("Oq1md2l", SharedOq1mq2l);
+		x->AddToTempData(slotq2g, Sharedq2g);
+		x->AddToTempData(slotgam, Sharedgam);
+		x->AddToTempData(slotOq1mq2l, SharedOq1mq2l);
 		if (rotated)
 		{
-			x->AddToTempData("Oq1", SharedOq1);
+			x->AddToTempData(slotOq1, SharedOq1);
 		}
 		return result;
 	};
@@ -191,14 +327,14 @@ namespace ROPTLIB{
 	{
 		const double *l = x->ObtainReadData();
 
-		const SharedSpace *Sharedq2g = x->ObtainReadTempData("q2g");
+		const SharedSpace *Sharedq2g = x->ObtainReadTempData(slotq2g);
 		const double *q2g = Sharedq2g->ObtainReadData();
-		const SharedSpace *Sharedgam = x->ObtainReadTempData("gamma");
+		const SharedSpace *Sharedgam = x->ObtainReadTempData(slotgam);
 		const double *gam = Sharedgam->ObtainReadData();
 		const double *Oq1 = q1;
 		if (rotated)
 		{
-			const SharedSpace *SharedOq1 = x->ObtainReadTempData("Oq1");
+			const SharedSpace *SharedOq1 = x->ObtainReadTempData(slotOq1);
 			Oq1 = SharedOq1->ObtainReadData();
 		}
 		// obtain q2' \circ gamma
@@ -206,18 +342,12 @@ namespace ROPTLIB{
 		double *dq2g = Shareddq2g->ObtainWriteEntireData();
 		double intv = 1.0 / (n - 1);
 
-		for (integer i = 0; i < n; i++)
-		{
-			for (integer j = 0; j < d; j++)
-			{
-				dq2g[i + j * n] = Spline::ValFirstDeriUniform(dq2_coefs + j * 3 * (n - 1), n, intv, gam[i]);
-			}
-		}
+		Spline::ValFirstDeriUniformBatch(dq2_coefs, n, d, intv, gam, n, dq2g);
 		// x, dy
-		double *xx = new double[2 * n];
+		double *xx = MemoryPool::NewDoubles(2 * n);
 		double *dyy = xx + n;
 
-		const SharedSpace *SharedOq1mq2l = x->ObtainReadTempData("Oq1md2l");
+		const SharedSpace *SharedOq1mq2l = x->ObtainReadTempData(slotOq1mq2l);
 		const double *Oq1mq2l = SharedOq1mq2l->ObtainReadData();
 		for (integer i = 0; i < n; i++)
 		{
@@ -236,6 +366,57 @@ namespace ROPTLIB{
 		double *dl = egf->ObtainWriteEntireData();
 		double *dO = dl + n;
 		double *dm = dO + d * d;
+		EucGradFromSamples(l, q2g, xx, dyy, yy, dl, dO);
+		//ForDebug::Print("dO:", dO, d, d);//---
+		// compute dm
+		if (isclosed)
+		{
+			double tmp = 0;
+			dm[0] = 0;
+			for (integer j = 0; j < d; j++)
+			{
+				tmp += Oq1mq2l[0 + j * n] * l[0] * dq2g[0 + j * n];
+			}
+			tmp /= 2;
+			dm[0] = tmp;
+			for (integer i = 1; i < n - 1; i++)
+			{
+				tmp = 0;
+				for (integer j = 0; j < d; j++)
+				{
+					tmp += Oq1mq2l[i + j * n] * l[i] * dq2g[i + j * n];
+				}
+				dm[0] += tmp;
+			}
+			tmp = 0;
+			for (integer j = 0; j < d; j++)
+			{
+				tmp += Oq1mq2l[n - 1 + j * n] * l[n - 1] * dq2g[n - 1 + j * n];
+			}
+			dm[0] += tmp / 2;
+			dm[0] *= -2.0 / (n - 1);
+		}
+		else
+		{
+			dm[0] = 0;
+		}
+
+		if (UseHess)
+		{
+			x->AddToTempData(slotdq2g, Shareddq2g);
+			x->AddToTempData(slotyy, Sharedyy);
+		}
+		else
+		{
+			delete Shareddq2g;
+			delete Sharedyy;
+		}
+		MemoryPool::DeleteDoubles(xx, 2 * n);
+	};
+
+	void ElasticCurvesRO::EucGradFromSamples(const double *l, const double *q2g, const double *xx, const double *dyy,
+		double *yy, double *dl, double *dO) const
+	{
 		// compute dl
 		integer deno = 2 * (n - 1);
 		yy[0] = 0;
@@ -285,79 +466,34 @@ namespace ROPTLIB{
 				dO[i] = 0;
 			}
 		}
-		//ForDebug::Print("dO:", dO, d, d);//---
-		// compute dm
-		if (isclosed)
-		{
-			double tmp = 0;
-			dm[0] = 0;
-			for (integer j = 0; j < d; j++)
-			{
-				tmp += Oq1mq2l[0 + j * n] * l[0] * dq2g[0 + j * n];
-			}
-			tmp /= 2;
-			dm[0] = tmp;
-			for (integer i = 1; i < n - 1; i++)
-			{
-				tmp = 0;
-				for (integer j = 0; j < d; j++)
-				{
-					tmp += Oq1mq2l[i + j * n] * l[i] * dq2g[i + j * n];
-				}
-				dm[0] += tmp;
-			}
-			tmp = 0;
-			for (integer j = 0; j < d; j++)
-			{
-				tmp += Oq1mq2l[n - 1 + j * n] * l[n - 1] * dq2g[n - 1 + j * n];
-			}
-			dm[0] += tmp / 2;
-			dm[0] *= -2.0 / (n - 1);
-		}
-		else
-		{
-			dm[0] = 0;
-		}
-
-		if (UseHess)
-		{
-			x->AddToTempData("dq2g", Shareddq2g);
-			x->AddToTempData("yy", Sharedyy);
-		}
-		else
-		{
-			delete Shareddq2g;
-			delete Sharedyy;
-		}
-		delete[] xx;
 	};
 
 	void ElasticCurvesRO::EucHessianEta(Variable *x, Vector *etax, Vector *exix) const
 	{
 		const double *l = x->ObtainReadData();
 
-		const SharedSpace *Sharedq2g = x->ObtainReadTempData("q2g");
+		const SharedSpace *Sharedq2g = x->ObtainReadTempData(slotq2g);
 		const double *q2g = Sharedq2g->ObtainReadData();
-		const SharedSpace *Sharedgam = x->ObtainReadTempData("gamma");
+		const SharedSpace *Sharedgam = x->ObtainReadTempData(slotgam);
 		const double *gam = Sharedgam->ObtainReadData();
 		const double *Oq1 = q1;
 		if (rotated)
 		{
-			const SharedSpace *SharedOq1 = x->ObtainReadTempData("Oq1");
+			const SharedSpace *SharedOq1 = x->ObtainReadTempData(slotOq1);
 			Oq1 = SharedOq1->ObtainReadData();
 		}
-		const SharedSpace *SharedOq1mq2l = x->ObtainReadTempData("Oq1md2l");
+		const SharedSpace *SharedOq1mq2l = x->ObtainReadTempData(slotOq1mq2l);
 		const double *Oq1mq2l = SharedOq1mq2l->ObtainReadData();
-		const SharedSpace *Shareddq2g = x->ObtainReadTempData("dq2g");
+		const SharedSpace *Shareddq2g = x->ObtainReadTempData(slotdq2g);
 		const double *dq2g = Shareddq2g->ObtainReadData();
-		const SharedSpace *Sharedyy = x->ObtainReadTempData("yy");
+		const SharedSpace *Sharedyy = x->ObtainReadTempData(slotyy);
 		const double *yy = Sharedyy->ObtainReadData();
 
 		const double *v = etax->ObtainReadData();
 		const double *U = v + n;
 		const double *a = U + d * d;
 
-		double *Uq1 = new double[n * d + 2 * n + 3 * n * d + 2 * n];
+		double *Uq1 = MemoryPool::NewDoubles(n * d + 2 * n + 3 * n * d + 2 * n);
 		double *tmpn = Uq1 + d * n;
 		double *tmpn2 = tmpn + n;
 		double *Dq2gva = tmpn2 + n;
@@ -375,20 +511,14 @@ namespace ROPTLIB{
 		// Dq2gva <- a * dq2g + Dq2gva, details: http://www.netlib.org/lapack/explore-html/d9/dcd/daxpy_8f.html
 		daxpy_(&nd, const_cast<double *> (a), const_cast<double *> (dq2g), &inc, Dq2gva, &inc);
 
-		if (!x->TempDataExist("ddq2g"))
+		if (!x->TempDataExist(slotddq2g))
 		{
 			SharedSpace *Sharedddq2g = new SharedSpace(1, n * d);
 			double *ddq2g = Sharedddq2g->ObtainWriteEntireData();
-			for (integer i = 0; i < n; i++)
-			{
-				for (integer j = 0; j < d; j++)
-				{
-					ddq2g[i + j * n] = Spline::ValSecondDeriUniform(ddq2_coefs + j * 2 * (n - 1), n, 1.0 / (n - 1), gam[i]);
-				}
-			}
-			x->AddToTempData("ddq2g", Sharedddq2g);
+			Spline::ValSecondDeriUniformBatch(ddq2_coefs, n, d, 1.0 / (n - 1), gam, n, ddq2g);
+			x->AddToTempData(slotddq2g, Sharedddq2g);
 		}
-		const SharedSpace *Sharedddq2g = x->ObtainReadTempData("ddq2g");
+		const SharedSpace *Sharedddq2g = x->ObtainReadTempData(slotddq2g);
 		const double *ddq2g = Sharedddq2g->ObtainReadData();
 
 		PointwiseQProdl(ddq2g, tmpn2, d, n, Ddq2gva);
@@ -538,7 +668,7 @@ namespace ROPTLIB{
 		}
 
 		//etax->CopyTo(exix);
-		delete[] Uq1;
+		MemoryPool::DeleteDoubles(Uq1, n * d + 2 * n + 3 * n * d + 2 * n);
 	};
 
 	void ElasticCurvesRO::PointwiseInnerProd(const double *q1, const double *q2, integer d, integer n, double *result)
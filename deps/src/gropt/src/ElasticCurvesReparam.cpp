@@ -1,5 +1,13 @@
 #include "ElasticCurvesReparam.h"
-std::map<integer *, integer> *CheckMemoryDeleted;
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef CHECKMEMORYDELETED
+namespace ROPTLIB{
+	std::map<integer *, integer> *CheckMemoryDeleted;
+};
+#endif
 
 using namespace ROPTLIB;
 
@@ -22,7 +30,9 @@ void optimum_reparam(double *C1, double *C2, int n, int d, double w,
 
     genrandseed(0);
 
+#ifdef CHECKMEMORYDELETED
     CheckMemoryDeleted = new std::map<integer *, integer>;
+#endif
 
 	integer numofmanis = 3;
 	integer numofmani1 = 1;
@@ -47,7 +57,8 @@ void optimum_reparam(double *C1, double *C2, int n, int d, double w,
 	dcopy_(&sizex, const_cast<double *> (Xoptptr), &inc, opt, &inc);
 
 	delete Xopt;
-	
+
+#ifdef CHECKMEMORYDELETED
 	std::map<integer *, integer>::iterator iter = CheckMemoryDeleted->begin();
 	for (iter = CheckMemoryDeleted->begin(); iter != CheckMemoryDeleted->end(); iter++)
 	{
@@ -55,5 +66,203 @@ void optimum_reparam(double *C1, double *C2, int n, int d, double w,
 			printf("Global address: %p, sharedtimes: %d\n", iter->first, iter->second);
 	}
 	delete CheckMemoryDeleted;
+#endif
 	return;
 }
+
+void optimum_reparam_telemetry(double *C1, double *C2, int n, int d, double w,
+        bool onlyDP, bool rotated, bool isclosed, int skipm, int autoselectC,
+        double *opt, int *swap, double *fopts, double *comtime,
+        double *optimes, double *records, int capacity, int *length)
+{
+    integer n1, d1;
+    n1 = static_cast<integer> (n);
+    d1 = static_cast<integer> (d);
+    bool swapi;
+
+    std::string methodname = "";
+    if (!onlyDP)
+        methodname = "LRBFGS";
+
+    genrandseed(0);
+
+    SolverTelemetry telemetry;
+    for (integer i = 0; i < TELEOPLENGTH; i++)
+        telemetry.times[i] = 0;
+    telemetry.records = records;
+    telemetry.capacity = (records == nullptr) ? 0 : static_cast<integer> (capacity);
+    telemetry.length = 0;
+
+    L2SphereVariable FNSV(n);
+    OrthGroupVariable OGV(d);
+    EucVariable EucV(1);
+    ProductElement Xopt(3, &FNSV, 1, &OGV, 1, &EucV, 1);
+    integer ns, lms;
+
+    DriverElasticCurvesROOptions options;
+    options.telemetry = &telemetry;
+    DriverElasticCurvesRO(C1, C2, d1, n1, w, rotated, isclosed, onlyDP, skipm, methodname,
+        autoselectC, &Xopt, swapi, fopts, comtime, ns, lms, nullptr, nullptr, options);
+
+    *swap = (swapi) ? 1 : 0;
+    for (integer i = 0; i < TELEOPLENGTH; i++)
+        optimes[i] = telemetry.times[i];
+    *length = static_cast<int> (telemetry.length);
+
+    integer sizex = n1 + d1 * d1 + 1;
+    const double *Xoptptr = Xopt.ObtainReadData();
+    integer inc = 1;
+    dcopy_(&sizex, const_cast<double *> (Xoptptr), &inc, opt, &inc);
+    return;
+}
+
+void optimum_reparam_warm(double *C1, double *C2, int n, int d, double w,
+        bool onlyDP, bool rotated, bool isclosed, int skipm, int autoselectC,
+        double *optinit, int swapinit, double warmtol,
+        double *opt, int *swap, double *fopts, double *comtime, int *warm)
+{
+    integer n1, d1;
+    n1 = static_cast<integer> (n);
+    d1 = static_cast<integer> (d);
+    bool swapi;
+
+    std::string methodname = "";
+    if (!onlyDP)
+        methodname = "LRBFGS";
+
+    genrandseed(0);
+
+    L2SphereVariable FNSV(n);
+    OrthGroupVariable OGV(d);
+    EucVariable EucV(1);
+    ProductElement Xopt(3, &FNSV, 1, &OGV, 1, &EucV, 1);
+    integer ns, lms;
+
+    // optinit is read before opt is written, so the two can be the same array
+    DriverElasticCurvesROOptions options;
+    options.Xinit = optinit;
+    options.swapinit = (swapinit != 0);
+    options.warmtol = warmtol;
+    DriverElasticCurvesRO(C1, C2, d1, n1, w, rotated, isclosed, onlyDP, skipm, methodname,
+        autoselectC, &Xopt, swapi, fopts, comtime, ns, lms, nullptr, nullptr, options);
+
+    *swap = (swapi) ? 1 : 0;
+    *warm = (optinit != nullptr && !onlyDP && lms == 0) ? 1 : 0;
+
+    integer sizex = n1 + d1 * d1 + 1;
+    const double *Xoptptr = Xopt.ObtainReadData();
+    integer inc = 1;
+    dcopy_(&sizex, const_cast<double *> (Xoptptr), &inc, opt, &inc);
+    return;
+}
+
+void optimum_reparam_batch(double *C1, double *C2, int n, int d, int K, bool pairs, double w,
+        bool onlyDP, bool rotated, bool isclosed, int skipm, int autoselectC,
+        int nthreads, double *opt, int *swap, double *fopts, double *comtime)
+{
+    integer n1, d1;
+    n1 = static_cast<integer> (n);
+    d1 = static_cast<integer> (d);
+    integer sizex = n1 + d1 * d1 + 1;
+    integer lenC = n1 * d1;
+
+    std::string methodname = "";
+    if (!onlyDP)
+        methodname = "LRBFGS";
+
+    // the template does not change over the batch, so its SRVF and total angle are computed once
+    double *Q1 = nullptr;
+    double TAC1 = 0;
+    bool *swapk = nullptr;
+    integer *nsk = nullptr;
+    std::map<integer, double *> C1s;
+    if (!pairs)
+    {
+        Q1 = new double[lenC];
+        CurveToQ(C1, d1, n1, Q1, isclosed);
+        TAC1 = ComputeTotalAngle(C1, d1, n1);
+
+        // so is its coarse curve and SRVF for every number of coarse points used by the pairs that keep their order.
+        // This number is given by the template for closed curves and by the curve for open ones.
+        swapk = new bool[K];
+        nsk = new integer[K];
+        for (int k = 0; k < K; k++)
+        {
+            double TAC2 = ComputeTotalAngle(C2 + k * lenC, d1, n1);
+            swapk[k] = (autoselectC != 0 && TAC1 < TAC2);
+            nsk[k] = (isclosed) ? CoarseNumPoints(n1, TAC1) : CoarseNumPoints(n1, TAC2);
+            if (!onlyDP && !swapk[k] && C1s.find(nsk[k]) == C1s.end())
+            {
+                double *C1sk = new double[2 * d1 * nsk[k]];
+                GetCurveSmall(C1, C1sk, d1, n1, nsk[k], isclosed);
+                CurveToQ(C1sk, d1, nsk[k], C1sk + d1 * nsk[k], isclosed);
+                C1s[nsk[k]] = C1sk;
+            }
+        }
+    }
+
+#ifdef _OPENMP
+    if (nthreads <= 0)
+        nthreads = omp_get_max_threads();
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        { // the scope ends before Release below, so Xopt has given back its buffers
+            // each thread reuses one output element over its curves
+            genrandseed(0);
+            L2SphereVariable FNSV(n);
+            OrthGroupVariable OGV(d);
+            EucVariable EucV(1);
+            ProductElement Xopt(3, &FNSV, 1, &OGV, 1, &EucV, 1);
+            integer ns, lms;
+            bool swapi;
+            integer inc = 1;
+            DriverElasticCurvesROOptions options;
+            options.nthreads = 1;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int k = 0; k < K; k++)
+            {
+                double *C1k = (pairs) ? C1 + k * lenC : C1;
+                // the driver recomputes the SRVF of a swapped template from its shifts, so the
+                // precomputed ones are only given when the pair keeps its order
+                double *Q1k = nullptr;
+                options.optC1s = nullptr;
+                options.optns = 0;
+                if (!pairs && !swapk[k])
+                {
+                    Q1k = Q1;
+                    if (!onlyDP)
+                    {
+                        options.optC1s = C1s.find(nsk[k])->second;
+                        options.optns = nsk[k];
+                    }
+                }
+                // the curves of one pair run serially, the threads are used across pairs
+                DriverElasticCurvesRO(C1k, C2 + k * lenC, d1, n1, w, rotated, isclosed, onlyDP, skipm, methodname,
+                    autoselectC, &Xopt, swapi, fopts + 5 * k, comtime + 5 * k, ns, lms, Q1k, nullptr, options);
+                swap[k] = (swapi) ? 1 : 0;
+
+                const double *Xoptptr = Xopt.ObtainReadData();
+                dcopy_(&sizex, const_cast<double *> (Xoptptr), &inc, opt + k * sizex, &inc);
+            }
+        }
+#ifdef _OPENMP
+        // the worker threads outlive this call, so they give back the buffers they cached
+        if (omp_get_thread_num() != 0)
+            MemoryPool::Release();
+#endif
+    }
+
+    if (Q1 != nullptr)
+    {
+        delete[] Q1;
+        delete[] swapk;
+        delete[] nsk;
+    }
+    for (std::map<integer, double *>::iterator it = C1s.begin(); it != C1s.end(); it++)
+        delete[] it->second;
+    return;
+}
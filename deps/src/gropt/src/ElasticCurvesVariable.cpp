@@ -0,0 +1,57 @@
+
+#include "ElasticCurvesVariable.h"
+
+/*Define the namespace*/
+namespace ROPTLIB{
+
+	ElasticCurvesVariable::ElasticCurvesVariable(integer inn, integer ind)
+	{
+		n = inn;
+		d = ind;
+		Element::Initialization(1, n + d * d + 1);
+	};
+
+	ElasticCurvesVariable *ElasticCurvesVariable::ConstructEmpty(void) const
+	{
+		return new ElasticCurvesVariable(n, d);
+	};
+
+	void ElasticCurvesVariable::RandInManifold(void)
+	{
+		this->RandGaussian();
+		double *xptr = this->ObtainWritePartialData();
+
+		// l <- l / \|l\|_{L^2}
+		double norm = xptr[0] * xptr[0] / 2;
+		for (integer i = 1; i < n - 1; i++)
+		{
+			norm += xptr[i] * xptr[i];
+		}
+		norm += xptr[n - 1] * xptr[n - 1] / 2;
+		norm = sqrt(norm / (n - 1));
+		for (integer i = 0; i < n; i++)
+		{
+			xptr[i] /= norm;
+		}
+
+		// O <- the orthonormal factor of O by the modified Gram-Schmidt process
+		double *O = xptr + n;
+		for (integer j = 0; j < d; j++)
+		{
+			for (integer k = 0; k < j; k++)
+			{
+				double r = 0;
+				for (integer i = 0; i < d; i++)
+					r += O[i + k * d] * O[i + j * d];
+				for (integer i = 0; i < d; i++)
+					O[i + j * d] -= r * O[i + k * d];
+			}
+			norm = 0;
+			for (integer i = 0; i < d; i++)
+				norm += O[i + j * d] * O[i + j * d];
+			norm = sqrt(norm);
+			for (integer i = 0; i < d; i++)
+				O[i + j * d] /= norm;
+		}
+	};
+}; /*end of ROPTLIB namespace*/
@@ -0,0 +1,16 @@
+
+#include "ElasticCurvesVector.h"
+
+/*Define the namespace*/
+namespace ROPTLIB{
+
+	ElasticCurvesVector::ElasticCurvesVector(integer length)
+	{
+		Element::Initialization(1, length);
+	};
+
+	ElasticCurvesVector *ElasticCurvesVector::ConstructEmpty(void) const
+	{
+		return new ElasticCurvesVector(size[0]);
+	};
+}; /*end of ROPTLIB namespace*/
@@ -1,9 +1,46 @@
 
 #include "Element.h"
+#include <mutex>
 
 /*Define the namespace*/
 namespace ROPTLIB{
 
+	/*The names of the registered slots. Slots are only appended, under the mutex.*/
+	static std::mutex TempSlotMutex;
+	static std::string TempSlotNames[NUMTEMPSLOTS];
+	static integer NumTempSlots = 0;
+
+	integer Element::RegisterTempSlot(std::string name)
+	{
+		std::lock_guard<std::mutex> lock(TempSlotMutex);
+		for (integer i = 0; i < NumTempSlots; i++)
+		{
+			if (TempSlotNames[i] == name)
+				return i;
+		}
+		if (NumTempSlots == NUMTEMPSLOTS)
+		{
+			printf("Error: no temp data slot is left for %s, increase NUMTEMPSLOTS!\n", name.c_str());
+			exit(EXIT_FAILURE);
+		}
+		TempSlotNames[NumTempSlots] = name;
+		NumTempSlots++;
+		return NumTempSlots - 1;
+	};
+
+	std::string Element::GetTempSlotName(integer id)
+	{
+		std::lock_guard<std::mutex> lock(TempSlotMutex);
+		return TempSlotNames[id];
+	};
+
+	Element::Element(void)
+	{
+		for (integer i = 0; i < NUMTEMPSLOTS; i++)
+			TempSlots[i] = nullptr;
+		NumTempSlotData = 0;
+	};
+
 	Element::~Element(void)
 	{
 		RemoveAllFromTempData();
@@ -41,6 +78,26 @@ namespace ROPTLIB{
 				}
 			}
 		}
+		for (integer i = 0; i < NUMTEMPSLOTS; i++)
+		{
+			if (TempSlots[i] != nullptr)
+			{
+				if (eta->TempSlots[i] != nullptr)
+				{
+					TempSlots[i]->CopyTo(eta->TempSlots[i]);
+				}
+				else
+				{
+					SharedSpace *Temp = TempSlots[i]->ConstructEmpty();
+					TempSlots[i]->CopyTo(Temp);
+					eta->AddToTempData(i, Temp);
+				}
+			}
+			else
+			{
+				eta->RemoveFromTempData(i);
+			}
+		}
 	};
 
 	void Element::CopyTempDataTo(Element *eta)
@@ -61,18 +118,33 @@ namespace ROPTLIB{
 				eta->AddToTempData(thisiter->first, Temp);
 			}
 		}
+		for (integer i = 0; i < NUMTEMPSLOTS; i++)
+		{
+			if (TempSlots[i] == nullptr)
+				continue;
+			if (eta->TempSlots[i] != nullptr)
+			{
+				TempSlots[i]->CopyTo(eta->TempSlots[i]);
+			}
+			else
+			{
+				SharedSpace *Temp = TempSlots[i]->ConstructEmpty();
+				TempSlots[i]->CopyTo(Temp);
+				eta->AddToTempData(i, Temp);
+			}
+		}
 	};
 
-	void Element::RandUnform(double start, double end)
+	void Element::RandUnform(double start, double end, RandGenContext *ctx)
 	{
 		RemoveAllFromTempData();
-		SmartSpace::RandUnform(start, end);
+		SmartSpace::RandUnform(start, end, ctx);
 	};
 
-	void Element::RandGaussian(double mean, double variance)
+	void Element::RandGaussian(double mean, double variance, RandGenContext *ctx)
 	{
 		RemoveAllFromTempData();
-		SmartSpace::RandGaussian(mean, variance);
+		SmartSpace::RandGaussian(mean, variance, ctx);
 	};
 
 	double *Element::ObtainWriteEntireData(void)
@@ -101,20 +173,31 @@ namespace ROPTLIB{
 
 	void Element::Print(const char *name, bool isonlymain) const
 	{
-		if (TempData.size() > 0 && !isonlymain)
+		if (GetSizeofTempData() > 0 && !isonlymain)
 			printf("=================Main data: %s=========================\n", name);
 		SmartSpace::Print(name);
 
-		if (TempData.size() > 0 && !isonlymain)
+		if (GetSizeofTempData() > 0 && !isonlymain)
+			PrintTempData(name);
+	};
+
+	void Element::PrintTempData(const char *name) const
+	{
+		MAP::const_iterator thisiter;
+		for (thisiter = TempData.begin(); thisiter != TempData.end(); thisiter++)
+		{
+			printf("=================Temp data in %s ================\n", name);
+			thisiter->second->Print(thisiter->first.c_str());
+		}
+		for (integer i = 0; i < NUMTEMPSLOTS; i++)
 		{
-			MAP::const_iterator thisiter;
-			for (thisiter = TempData.begin(); thisiter != TempData.end(); thisiter++)
+			if (TempSlots[i] != nullptr)
 			{
 				printf("=================Temp data in %s ================\n", name);
-				thisiter->second->Print(thisiter->first.c_str());
+				TempSlots[i]->Print(GetTempSlotName(i).c_str());
 			}
-			printf("=================end of output: %s=========================\n", name);
 		}
+		printf("=================end of output: %s=========================\n", name);
 	};
 
 	void Element::RandInManifold(void)
@@ -183,6 +266,58 @@ namespace ROPTLIB{
 			delete thisiter->second;
 		}
 		TempData.clear();
+		for (integer i = 0; i < NUMTEMPSLOTS && NumTempSlotData > 0; i++)
+		{
+			if (TempSlots[i] != nullptr)
+			{
+				delete TempSlots[i];
+				TempSlots[i] = nullptr;
+				NumTempSlotData--;
+			}
+		}
+	};
+
+	void Element::AddToTempData(integer id, SharedSpace * &Temp)
+	{
+		if (TempSlots[id] == nullptr)
+		{
+			TempSlots[id] = Temp;
+			NumTempSlotData++;
+		}
+		else
+		{
+			Temp->CopyTo(TempSlots[id]);
+			delete Temp;
+		}
+		Temp = nullptr;
+	};
+
+	const SharedSpace *Element::ObtainReadTempData(integer id) const
+	{
+		if (TempSlots[id] == nullptr)
+		{
+			printf("Error: TempData %s does not exist!\n", GetTempSlotName(id).c_str());
+		}
+		return TempSlots[id];
+	};
+
+	SharedSpace *Element::ObtainWriteTempData(integer id)
+	{
+		if (TempSlots[id] == nullptr)
+		{
+			printf("Error: TempData %s does not exist!\n", GetTempSlotName(id).c_str());
+		}
+		return TempSlots[id];
+	};
+
+	void Element::RemoveFromTempData(integer id)
+	{
+		if (TempSlots[id] != nullptr)
+		{
+			delete TempSlots[id];
+			TempSlots[id] = nullptr;
+			NumTempSlotData--;
+		}
 	};
 
 	bool Element::TempDataExist(std::string name) const
@@ -210,5 +345,13 @@ namespace ROPTLIB{
 		{
 			names[idx].assign(thisiter->first);
 		}
+		for (integer i = 0; i < NUMTEMPSLOTS; i++)
+		{
+			if (TempSlots[i] != nullptr)
+			{
+				names[idx].assign(GetTempSlotName(i));
+				idx++;
+			}
+		}
 	};
 }; /*end of ROPTLIB namespace*/
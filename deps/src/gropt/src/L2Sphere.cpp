@@ -35,41 +35,77 @@ namespace ROPTLIB{
 		delete EMPTYINTR;
 	};
 
-	double L2Sphere::Metric(Variable *x, Vector *etax, Vector *xix) const
-	{ //Trapezoidal rule
-		const double *etaxTV = etax->ObtainReadData();
-		const double *xixTV = xix->ObtainReadData();
+	double L2Sphere::TrapezoidDot(const double *a, const double *b) const
+	{
 		integer inc = 1;
-		// In Matlab environment, the following library produces different results from different runs, which
-		// I don't know why. However, it can be fixed by the next 3 lines of codes, which is slower.
-
-		// output etaxTV^T xixTV, details: http://www.netlib.org/lapack/explore-html/d5/df6/ddot_8f.html
-		double result = ddot_(&n, const_cast<double *> (etaxTV), &inc, const_cast<double *> (xixTV), &inc);
-		//double result = 0;
-		//for (integer i = 0; i < n; i++)
-		//	result += etaxTV[i] * xixTV[i];
-		result -= etaxTV[0] * xixTV[0] / 2;
-		result -= etaxTV[n - 1] * xixTV[n - 1] / 2;
+		// The interior points have weight 1 and the two end points 1/2.
+		// In Matlab environment, ddot produces different results from different runs, which I don't know why.
+		// However, it can be fixed by a plain loop, which is slower.
+		// output a^T b, details: http://www.netlib.org/lapack/explore-html/d5/df6/ddot_8f.html
+		double result = ddot_(&n, const_cast<double *> (a), &inc, const_cast<double *> (b), &inc);
+		result -= (a[0] * b[0] + a[n - 1] * b[n - 1]) / 2;
 		return result / (n - 1);
 	};
 
+	void L2Sphere::MetricAxpy(double scalar, const double *u, const double *v, const double *w, const double *z, double *result) const
+	{
+		double coef = scalar * TrapezoidDot(u, v);
+		// the update is elementwise, so result may alias any of the inputs
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for (integer i = 0; i < n; i++)
+			result[i] = z[i] + coef * w[i];
+	};
+
+	double L2Sphere::Metric(Variable *x, Vector *etax, Vector *xix) const
+	{ //Trapezoidal rule
+		return TrapezoidDot(etax->ObtainReadData(), xix->ObtainReadData());
+	};
+
 	void L2Sphere::Projection(Variable *x, Vector *v, Vector *result) const
 	{
 		const double *xl = x->ObtainReadData();
-		double nume = Metric(x, x, v);
-		scalarVectorAddVector(x, -nume, x, v, result);
+		const double *vl = v->ObtainReadData();
+		// result = v - g(x, v) x
+		MetricAxpy(-1.0, xl, vl, xl, vl, result->ObtainWriteEntireData());
 	};
 
 	void L2Sphere::Retraction(Variable *x, Vector *etax, Variable *result, double stepsize) const
 	{// exponential mapping
-		double norm = sqrt(Metric(x, etax, etax));
-		if (norm < std::numeric_limits<double>::epsilon())
-			ScaleTimesVector(x, cos(norm), x, result);
-		else
-			VectorLinearCombination(x, cos(norm), x, sin(norm) / norm, etax, result);
-
-		norm = sqrt(this->Metric(x, result, result));
-		this->ScaleTimesVector(x, 1.0 / norm, result, result);
+		const double *xl = x->ObtainReadData();
+		const double *etaxTV = etax->ObtainReadData();
+
+		// g(eta, eta), g(x, eta) and g(x, x) in one pass
+		double ee = (etaxTV[0] * etaxTV[0] + etaxTV[n - 1] * etaxTV[n - 1]) / 2;
+		double xe = (xl[0] * etaxTV[0] + xl[n - 1] * etaxTV[n - 1]) / 2;
+		double xx = (xl[0] * xl[0] + xl[n - 1] * xl[n - 1]) / 2;
+#ifdef _OPENMP
+#pragma omp simd reduction(+:ee, xe, xx)
+#endif
+		for (integer i = 1; i < n - 1; i++)
+		{
+			ee += etaxTV[i] * etaxTV[i];
+			xe += xl[i] * etaxTV[i];
+			xx += xl[i] * xl[i];
+		}
+		ee /= (n - 1);
+		xe /= (n - 1);
+		xx /= (n - 1);
+
+		double norm = sqrt(ee);
+		double a = cos(norm), b = (norm < std::numeric_limits<double>::epsilon()) ? 0 : sin(norm) / norm;
+		// normalize by \|a x + b eta\|, which follows from the metrics above
+		double scale = 1.0 / sqrt(a * a * xx + 2 * a * b * xe + b * b * ee);
+		a *= scale;
+		b *= scale;
+
+		double *resultTV = result->ObtainWriteEntireData();
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for (integer i = 0; i < n; i++)
+			resultTV[i] = a * xl[i] + b * etaxTV[i];
 	};
 
 	void L2Sphere::coTangentVector(Variable *x, Vector *etax, Variable *y, Vector *xiy, Vector *result) const
@@ -116,46 +152,60 @@ namespace ROPTLIB{
 		return 1;
 	};
 
-	void L2Sphere::VectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xix, Vector *result) const
+	void L2Sphere::ObtainXdydn2(Variable *x, Vector *etax, Variable *y) const
 	{
-		if (!etax->TempDataExist("xdydn2"))
+		if (etax->TempDataExist("xdydn2"))
+			return;
+		Vector *xdy = x->ConstructEmpty();
+		SharedSpace *Sharedxdy = new SharedSpace(xdy);
+		const double *xl = x->ObtainReadData();
+		const double *yl = y->ObtainReadData();
+		double *xdyTV = xdy->ObtainWriteEntireData();
+		// xdy = x + y and its squared norm in one pass, then the scaling
+		double nrm2 = 0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+:nrm2)
+#endif
+		for (integer i = 1; i < n - 1; i++)
 		{
-			Vector *xdy = x->ConstructEmpty();
-			SharedSpace *Sharedxdy = new SharedSpace(xdy);
-			VectorAddVector(x, x, y, xdy);
-			ScaleTimesVector(x, 1.0 / Metric(x, xdy, xdy), xdy, xdy);
-			etax->AddToTempData("xdydn2", Sharedxdy);
+			xdyTV[i] = xl[i] + yl[i];
+			nrm2 += xdyTV[i] * xdyTV[i];
 		}
+		xdyTV[0] = xl[0] + yl[0];
+		xdyTV[n - 1] = xl[n - 1] + yl[n - 1];
+		nrm2 = (nrm2 + (xdyTV[0] * xdyTV[0] + xdyTV[n - 1] * xdyTV[n - 1]) / 2) / (n - 1);
+		double scale = 1.0 / nrm2;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for (integer i = 0; i < n; i++)
+			xdyTV[i] *= scale;
+		etax->AddToTempData("xdydn2", Sharedxdy);
+	};
+
+	void L2Sphere::VectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xix, Vector *result) const
+	{
+		ObtainXdydn2(x, etax, y);
 		const SharedSpace *Sharedxdydn2 = etax->ObtainReadTempData("xdydn2");
 		Vector *xdydn2 = Sharedxdydn2->GetSharedElement();
-		scalarVectorAddVector(x, -2.0 * Metric(x, xix, y), xdydn2, xix, result);
+		const double *xixTV = xix->ObtainReadData();
+		// result = xix - 2 g(xix, y) (x + y) / \|x + y\|^2
+		MetricAxpy(-2.0, xixTV, y->ObtainReadData(), xdydn2->ObtainReadData(), xixTV, result->ObtainWriteEntireData());
 	};
 
 	void L2Sphere::InverseVectorTransport(Variable *x, Vector *etax, Variable *y, Vector *xiy, Vector *result) const
 	{
-		if (!etax->TempDataExist("xdydn2"))
-		{
-			Vector *xdy = x->ConstructEmpty();
-			SharedSpace *Sharedxdy = new SharedSpace(xdy);
-			VectorAddVector(x, x, y, xdy);
-			ScaleTimesVector(x, 1.0 / Metric(x, xdy, xdy), xdy, xdy);
-			etax->AddToTempData("xdydn2", Sharedxdy);
-		}
+		ObtainXdydn2(x, etax, y);
 		const SharedSpace *Sharedxdydn2 = etax->ObtainReadTempData("xdydn2");
 		Vector *xdydn2 = Sharedxdydn2->GetSharedElement();
-		scalarVectorAddVector(x, -2.0 * Metric(x, xiy, x), xdydn2, xiy, result);
+		const double *xiyTV = xiy->ObtainReadData();
+		// result = xiy - 2 g(xiy, x) (x + y) / \|x + y\|^2
+		MetricAxpy(-2.0, xiyTV, x->ObtainReadData(), xdydn2->ObtainReadData(), xiyTV, result->ObtainWriteEntireData());
 	};
 
 	void L2Sphere::HInvTran(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, integer start, integer end, LinearOPE *result) const
 	{
-		if (!etax->TempDataExist("xdydn2"))
-		{
-			Vector *xdy = x->ConstructEmpty();
-			SharedSpace *Sharedxdy = new SharedSpace(xdy);
-			VectorAddVector(x, x, y, xdy);
-			ScaleTimesVector(x, 1.0 / Metric(x, xdy, xdy), xdy, xdy);
-			etax->AddToTempData("xdydn2", Sharedxdy);
-		}
+		ObtainXdydn2(x, etax, y);
 		const SharedSpace *Sharedxdydn2 = etax->ObtainReadTempData("xdydn2");
 		Vector *xdydn2 = Sharedxdydn2->GetSharedElement();
 		const double *xdydn2TV = xdydn2->ObtainReadData();
@@ -194,14 +244,7 @@ namespace ROPTLIB{
 
 	void L2Sphere::TranH(Variable *x, Vector *etax, Variable *y, LinearOPE *Hx, integer start, integer end, LinearOPE *result) const
 	{
-		if (!etax->TempDataExist("xdydn2"))
-		{
-			Vector *xdy = x->ConstructEmpty();
-			SharedSpace *Sharedxdy = new SharedSpace(xdy);
-			VectorAddVector(x, x, y, xdy);
-			ScaleTimesVector(x, 1.0 / Metric(x, xdy, xdy), xdy, xdy);
-			etax->AddToTempData("xdydn2", Sharedxdy);
-		}
+		ObtainXdydn2(x, etax, y);
 
 		integer ell = Hx->Getsize()[0];
 		integer length = etax->Getlength();
@@ -250,10 +293,14 @@ namespace ROPTLIB{
 
 	void L2Sphere::ObtainEtaxFlat(Variable *x, Vector *etax, Vector *etaxflat) const
 	{
-		etax->CopyTo(etaxflat);
-		double *etaxflatTV = etaxflat->ObtainWritePartialData();
+		const double *etaxTV = etax->ObtainReadData();
+		double *etaxflatTV = etaxflat->ObtainWriteEntireData();
 		double intv = 1.0 / (n - 1);
-		ScaleTimesVector(x, intv, etaxflat, etaxflat);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for (integer i = 0; i < n; i++)
+			etaxflatTV[i] = etaxTV[i] * intv;
 		etaxflatTV[0] /= 2;
 		etaxflatTV[n - 1] /= 2;
 	};
@@ -276,8 +323,9 @@ namespace ROPTLIB{
 	void L2Sphere::ExtrProjection(Variable *x, Vector *v, Vector *result) const
 	{
 		const double *xl = x->ObtainReadData();
-		double nume = Metric(x, x, v);
-		scalarVectorAddVector(x, -nume, x, v, result);
+		const double *vl = v->ObtainReadData();
+		// result = v - g(x, v) x
+		MetricAxpy(-1.0, xl, vl, xl, vl, result->ObtainWriteEntireData());
 	};
 
 	void L2Sphere::CheckParams(void) const
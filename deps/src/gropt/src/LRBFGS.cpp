@@ -33,11 +33,17 @@ namespace ROPTLIB{
 		nu = 1e-4;
 		mu = 1;
 		LengthSY = 4;
+		TransportFree = false;
+		CompactForm = false;
+		SYmat = nullptr;
+		SYinp = nullptr;
+		SYwork = nullptr;
 		S = nullptr;
 		Y = nullptr;
 		Currentlength = 0;
 		beginidx = 0;
 		RHO = nullptr;
+		LengthSYAllocated = 0;
 		gamma = 1;
 		InitSteptype = QUADINTMOD;
 		SolverName.assign("LRBFGS");
@@ -48,24 +54,68 @@ namespace ROPTLIB{
 		delete s;
 		delete y;
 		delete Py;
-		DeleteVectors(S, LengthSY);
-		DeleteVectors(Y, LengthSY);
+		DeleteVectors(S, LengthSYAllocated);
+		DeleteVectors(Y, LengthSYAllocated);
 		if (RHO != nullptr)
 			delete[] RHO;
+		if (SYmat != nullptr)
+			delete[] SYmat;
 	};
 
 	void LRBFGS::Run(void)
 	{
-		DeleteVectors(S, LengthSY);
-		NewVectors(S, LengthSY);
-		DeleteVectors(Y, LengthSY);
-		NewVectors(Y, LengthSY);
-		if (RHO != nullptr)
-			delete[] RHO;
-		RHO = new double[LengthSY];
+		/*S, Y, RHO and SYmat are kept from the previous run if LengthSY and CompactForm are not changed*/
+		if (S == nullptr || LengthSYAllocated != LengthSY)
+		{
+			DeleteVectors(S, LengthSYAllocated);
+			NewVectors(S, LengthSY);
+			DeleteVectors(Y, LengthSYAllocated);
+			NewVectors(Y, LengthSY);
+			if (RHO != nullptr)
+				delete[] RHO;
+			RHO = new double[LengthSY];
+			if (SYmat != nullptr)
+				delete[] SYmat;
+			SYmat = nullptr;
+			SYinp = nullptr;
+			SYwork = nullptr;
+			LengthSYAllocated = LengthSY;
+		}
+		if (!CompactForm && SYmat != nullptr)
+		{
+			delete[] SYmat;
+			SYmat = nullptr;
+			SYinp = nullptr;
+			SYwork = nullptr;
+		}
+		if (CompactForm)
+		{
+			integer length = gf1->Getlength();
+			/*SYmat, SYinp and the workspace of HvLRBFGSCompact, which is called for every search direction*/
+			integer lengthSY = 2 * LengthSY * length + 2 * LengthSY * LengthSY + 6 * LengthSY + 2 * LengthSY * LengthSY;
+			if (SYmat == nullptr)
+			{
+				SYmat = new double[lengthSY];
+				SYinp = SYmat + 2 * LengthSY * length;
+				SYwork = SYinp + 2 * LengthSY * LengthSY;
+			}
+			/*the unused columns are multiplied by zero in HvLRBFGSCompact, so they must not hold NaNs*/
+			for (integer i = 0; i < lengthSY; i++)
+				SYmat[i] = 0;
+		}
 		SolversLS::Run();
 	};
 
+	bool LRBFGS::Reset(const Problem *prob, const Variable *initialx)
+	{
+		if (!SolversLS::Reset(prob, initialx))
+			return false;
+		Currentlength = 0;
+		beginidx = 0;
+		gamma = 1;
+		return true;
+	};
+
 	void LRBFGS::CheckParams(void)
 	{
 		SolversLS::CheckParams();
@@ -81,7 +131,10 @@ namespace ROPTLIB{
 		status = YES;
 		printf("isconvex      :%15d[%s],\t", isconvex, status);
 		status = (LengthSY >= 0) ? YES : NO;
-		printf("LengthSY      :%15d[%s]\n", LengthSY, status);
+		printf("LengthSY      :%15d[%s],\t", LengthSY, status);
+		status = YES;
+		printf("TransportFree :%15d[%s],\t", TransportFree, status);
+		printf("CompactForm   :%15d[%s]\n", CompactForm, status);
 	};
 
 	void LRBFGS::GetSearchDir(void)
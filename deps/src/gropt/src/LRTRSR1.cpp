@@ -82,6 +82,16 @@ namespace ROPTLIB{
 			delete[] Psi;
 	};
 
+	bool LRTRSR1::Reset(const Problem *prob, const Variable *initialx)
+	{
+		if (!SolversTR::Reset(prob, initialx))
+			return false;
+		Currentlength = 0;
+		beginidx = 0;
+		gamma = 1;
+		return true;
+	};
+
 	void LRTRSR1::Run(void)
 	{
 		DeleteVectors(S, LengthSY);
@@ -112,11 +112,11 @@ namespace ROPTLIB{
 		}
 	};
 
-	void Manifold::RandomTangentVectors(Variable *x, integer N, Vector **result_arr) const // Be careful
+	void Manifold::RandomTangentVectors(Variable *x, integer N, Vector **result_arr, RandGenContext *ctx) const // Be careful
 	{
 		for (integer i = 0; i < N; i++)
 		{
-			result_arr[i]->RandGaussian();
+			result_arr[i]->RandGaussian(0, 1, ctx);
 			this->Projection(x, result_arr[i], result_arr[i]);
 		}
 	};
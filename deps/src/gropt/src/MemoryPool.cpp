@@ -0,0 +1,158 @@
+
+#include "MemoryPool.h"
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+/*Define the namespace*/
+namespace ROPTLIB{
+
+	static std::atomic<bool> PoolEnabled(true);
+
+	static std::atomic<integer> PoolNumNew(0), PoolNumReused(0), PoolNumDelete(0), PoolNumCached(0),
+		PoolNumNewCounter(0), PoolNumReusedCounter(0), PoolNumDeleteCounter(0), PoolNumCachedCounter(0),
+		PoolNumReleased(0);
+
+	/*The free lists of one thread. They are freed when the thread exits.*/
+	class ThreadPool{
+	public:
+		std::unordered_map<integer, std::vector<double *> > Doubles;
+		std::vector<integer *> Counters;
+		size_t Bytes; /*The bytes of the buffers in Doubles*/
+
+		ThreadPool(void) : Bytes(0) {};
+
+		void Release(void)
+		{
+			integer numreleased = 0;
+			std::unordered_map<integer, std::vector<double *> >::iterator iter;
+			for (iter = Doubles.begin(); iter != Doubles.end(); iter++)
+			{
+				for (size_t i = 0; i < iter->second.size(); i++)
+					delete[] iter->second[i];
+				numreleased += static_cast<integer> (iter->second.size());
+			}
+			Doubles.clear();
+			Bytes = 0;
+			for (size_t i = 0; i < Counters.size(); i++)
+				delete Counters[i];
+			numreleased += static_cast<integer> (Counters.size());
+			Counters.clear();
+			PoolNumReleased.fetch_add(numreleased, std::memory_order_relaxed);
+		};
+
+		~ThreadPool(void)
+		{
+			Release();
+		};
+	};
+
+	static thread_local ThreadPool LocalPool;
+
+	void MemoryPool::SetEnabled(bool enabled)
+	{
+		PoolEnabled.store(enabled);
+	};
+
+	bool MemoryPool::IsEnabled(void)
+	{
+		return PoolEnabled.load(std::memory_order_relaxed);
+	};
+
+	double *MemoryPool::NewDoubles(integer length)
+	{
+		PoolNumNew.fetch_add(1, std::memory_order_relaxed);
+		if (IsEnabled() && length <= POOLMAXLENGTH)
+		{
+			std::unordered_map<integer, std::vector<double *> >::iterator iter = LocalPool.Doubles.find(length);
+			if (iter != LocalPool.Doubles.end() && !iter->second.empty())
+			{
+				double *ptr = iter->second.back();
+				iter->second.pop_back();
+				LocalPool.Bytes -= sizeof(double) * length;
+				PoolNumReused.fetch_add(1, std::memory_order_relaxed);
+				return ptr;
+			}
+		}
+		return new double[length];
+	};
+
+	void MemoryPool::DeleteDoubles(double *ptr, integer length)
+	{
+		if (ptr == nullptr)
+			return;
+		PoolNumDelete.fetch_add(1, std::memory_order_relaxed);
+		if (IsEnabled() && length <= POOLMAXLENGTH && LocalPool.Bytes + sizeof(double) * length <= POOLMAXBYTES)
+		{
+			std::vector<double *> &freelist = LocalPool.Doubles[length];
+			if (freelist.size() < POOLMAXFREE)
+			{
+				freelist.push_back(ptr);
+				LocalPool.Bytes += sizeof(double) * length;
+				PoolNumCached.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+		delete[] ptr;
+	};
+
+	integer *MemoryPool::NewCounter(void)
+	{
+		PoolNumNewCounter.fetch_add(1, std::memory_order_relaxed);
+		if (IsEnabled() && !LocalPool.Counters.empty())
+		{
+			integer *ptr = LocalPool.Counters.back();
+			LocalPool.Counters.pop_back();
+			PoolNumReusedCounter.fetch_add(1, std::memory_order_relaxed);
+			return ptr;
+		}
+		return new integer;
+	};
+
+	void MemoryPool::DeleteCounter(integer *ptr)
+	{
+		if (ptr == nullptr)
+			return;
+		PoolNumDeleteCounter.fetch_add(1, std::memory_order_relaxed);
+		if (IsEnabled() && LocalPool.Counters.size() < POOLMAXFREE)
+		{
+			LocalPool.Counters.push_back(ptr);
+			PoolNumCachedCounter.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		delete ptr;
+	};
+
+	void MemoryPool::Release(void)
+	{
+		LocalPool.Release();
+	};
+
+	MemoryPoolCounters MemoryPool::GetCounters(void)
+	{
+		MemoryPoolCounters result;
+		result.NumNew = PoolNumNew.load();
+		result.NumReused = PoolNumReused.load();
+		result.NumDelete = PoolNumDelete.load();
+		result.NumCached = PoolNumCached.load();
+		result.NumNewCounter = PoolNumNewCounter.load();
+		result.NumReusedCounter = PoolNumReusedCounter.load();
+		result.NumDeleteCounter = PoolNumDeleteCounter.load();
+		result.NumCachedCounter = PoolNumCachedCounter.load();
+		result.NumReleased = PoolNumReleased.load();
+		return result;
+	};
+
+	void MemoryPool::ResetCounters(void)
+	{
+		PoolNumNew.store(0);
+		PoolNumReused.store(0);
+		PoolNumDelete.store(0);
+		PoolNumCached.store(0);
+		PoolNumNewCounter.store(0);
+		PoolNumReusedCounter.store(0);
+		PoolNumDeleteCounter.store(0);
+		PoolNumCachedCounter.store(0);
+		PoolNumReleased.store(0);
+	};
+}; /*end of ROPTLIB namespace*/
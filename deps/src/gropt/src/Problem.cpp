@@ -191,6 +191,18 @@ namespace ROPTLIB{
 		delete gfy;
 	};
 
+	double Problem::FuncGrad(Variable *x, Vector *gf) const
+	{
+		double fx = f(x);
+		Grad(x, gf);
+		return fx;
+	};
+
+	bool Problem::HasFuncGrad(void) const
+	{
+		return false;
+	};
+
 	void Problem::PreConditioner(Variable *x, Vector *eta, Vector *result) const
 	{
 		// default one means no preconditioner.
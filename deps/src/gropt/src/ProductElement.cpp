@@ -1,4 +1,5 @@
 #include "ProductElement.h"
+#include "MemoryPool.h"
 
 /*Define the namespace*/
 namespace ROPTLIB{
@@ -114,7 +115,7 @@ namespace ROPTLIB{
 		{
 			if (elements[powsinterval[i]]->GetSharedTimes() != nullptr)
 			{
-				delete elements[powsinterval[i]]->GetSharedTimes();
+				MemoryPool::DeleteCounter(const_cast<integer *> (elements[powsinterval[i]]->GetSharedTimes()));
 			}
 			if (elements[powsinterval[i]]->Getsize() != nullptr)
 				delete[] elements[powsinterval[i]]->Getsize();
@@ -154,20 +155,23 @@ namespace ROPTLIB{
 		Element::CopyTo(eta);
 		ProductElement *Prodeta = dynamic_cast<ProductElement *> (eta);
 		Prodeta->ResetMemoryofElementsAndSpace();
+		// the temporary data of the elements of eta belong to its previous data
+		for (integer i = 0; i < Prodeta->numofelements; i++)
+			Prodeta->elements[i]->RemoveAllFromTempData();
 	};
 
-	void ProductElement::RandUnform(double start, double end)
+	void ProductElement::RandUnform(double start, double end, RandGenContext *ctx)
 	{
 		ObtainWriteEntireData();
 		for (integer i = 0; i < numofelements; i++)
-			elements[i]->RandUnform(start, end);
+			elements[i]->RandUnform(start, end, ctx);
 	};
 
-	void ProductElement::RandGaussian(double mean, double variance)
+	void ProductElement::RandGaussian(double mean, double variance, RandGenContext *ctx)
 	{
 		ObtainWriteEntireData();
 		for (integer i = 0; i < numofelements; i++)
-			elements[i]->RandGaussian(mean, variance);
+			elements[i]->RandGaussian(mean, variance, ctx);
 	};
 
 	void ProductElement::Print(const char *name, bool isonlymain) const
@@ -181,16 +185,8 @@ namespace ROPTLIB{
 			std::string str = strStream.str();
 			elements[i]->Print(str.c_str(), isonlymain);
 		}
-		if (TempData.size() > 0 && !isonlymain)
-		{
-			MAP::const_iterator thisiter;
-			for (thisiter = TempData.begin(); thisiter != TempData.end(); thisiter++)
-			{
-				printf("=================Temp data in %s ================\n", name);
-				thisiter->second->Print(thisiter->first.c_str());
-			}
-			printf("=================end of output: %s=========================\n", name);
-		}
+		if (GetSizeofTempData() > 0 && !isonlymain)
+			PrintTempData(name);
 	};
 
 	void ProductElement::RandInManifold(void)
@@ -219,6 +215,13 @@ namespace ROPTLIB{
 		return Space;
 	};
 
+	void ProductElement::RemoveAllFromTempData(void)
+	{
+		Element::RemoveAllFromTempData();
+		for (integer i = 0; i < numofelements; i++)
+			elements[i]->RemoveAllFromTempData();
+	};
+
 	void ProductElement::CheckMemory(const char *info) const
 	{
 		for (integer i = 0; i < numoftypes; i++)
@@ -253,10 +256,10 @@ namespace ROPTLIB{
 
 		for (integer i = 0; i < numoftypes; i++)
 		{
-			isharedtimes = new integer;
+			isharedtimes = MemoryPool::NewCounter();
 			*isharedtimes = 1;
 			if (elements[powsinterval[i]]->GetSharedTimes() != nullptr)
-				delete elements[powsinterval[i]]->GetSharedTimes();
+				MemoryPool::DeleteCounter(const_cast<integer *> (elements[powsinterval[i]]->GetSharedTimes()));
 			for (integer j = powsinterval[i]; j < powsinterval[i + 1]; j++)
 			{
 				elements[j]->SetByParams(const_cast<integer *> (elements[j]->Getsize()), elements[j]->Getls(), elements[j]->Getlength(),
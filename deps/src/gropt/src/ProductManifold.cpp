@@ -31,6 +31,9 @@ namespace ROPTLIB{
 			numoftotalmani += (powsinterval[i + 1] - powsinterval[i]);
 		}
 		name.assign("Product Manifold");
+#ifdef TESTELASTICCURVESRO
+		slotw = Element::RegisterTempSlot("w");
+#endif
 		// For product manifold, individual manifolds are using their parameters, IsIntrApproach,
 		// to specify whether intrinsic approach is used or not.
 		IsIntrApproach = true;
@@ -122,6 +125,9 @@ namespace ROPTLIB{
 			numoftotalmani += (powsinterval[i + 1] - powsinterval[i]);
 		}
 		name.assign("Product Manifold");
+#ifdef TESTELASTICCURVESRO
+		slotw = Element::RegisterTempSlot("w");
+#endif
 		// For product manifold, either all the individual manifolds are using intrinsic approach
 		// or all of them are using extrinsic approach.
 		IsIntrApproach = true;
@@ -273,21 +279,22 @@ namespace ROPTLIB{
 #endif
 	};
 
-	void ProductManifold::RandomTangentVectors(Variable *x, integer N, Vector **result_arr) const
+	void ProductManifold::RandomTangentVectors(Variable *x, integer N, Vector **result_arr, RandGenContext *ctx) const
 	{
 	};
 
 	void ProductManifold::Retraction(Variable *x, Vector *etax, Variable *result, double instepsize) const
 	{
 #ifdef TESTELASTICCURVESRO
-		if (x->TempDataExist("w"))
+		// ElasticCurvesRO keeps w in a slot
+		if (x->TempDataExist(slotw))
 		{
-			const SharedSpace *Sharedw = x->ObtainReadTempData("w");
+			const SharedSpace *Sharedw = x->ObtainReadTempData(slotw);
 			const double *wptr = Sharedw->ObtainReadData();
 			SharedSpace *Sharedww = new SharedSpace(1, 1);
 			double *wwptr = Sharedww->ObtainWriteEntireData();
 			wwptr[0] = wptr[0] * 0.8;
-			result->AddToTempData("w", Sharedww);
+			result->AddToTempData(slotw, Sharedww);
 		}
 #endif
 		ProdVariable *prodx = dynamic_cast<ProdVariable *> (x);
@@ -605,6 +612,38 @@ namespace ROPTLIB{
 		delete prodxixflat;
 	};
 
+	void ProductManifold::ObtainEtaxFlat(Variable *x, Vector *etax, Vector *etaxflat) const
+	{
+		ProdVariable *prodx = dynamic_cast<ProdVariable *> (x);
+		ProdVector *prodetax = dynamic_cast<ProdVector *> (etax);
+		ProdVector *prodetaxflat = dynamic_cast<ProdVector *> (etaxflat);
+		if (etax == etaxflat)
+		{
+			ProdVector *prodetaxflatTemp = prodetaxflat->ConstructEmpty();
+			prodetaxflatTemp->NewMemoryOnWrite();
+			for (integer i = 0; i < numofmani; i++)
+			{
+				for (integer j = powsinterval[i]; j < powsinterval[i + 1]; j++)
+				{
+					manifolds[i]->ObtainEtaxFlat(prodx->GetElement(j), prodetax->GetElement(j), prodetaxflatTemp->GetElement(j));
+				}
+			}
+			prodetaxflatTemp->CopyTo(etaxflat);
+			delete prodetaxflatTemp;
+		}
+		else
+		{
+			prodetaxflat->NewMemoryOnWrite();
+			for (integer i = 0; i < numofmani; i++)
+			{
+				for (integer j = powsinterval[i]; j < powsinterval[i + 1]; j++)
+				{
+					manifolds[i]->ObtainEtaxFlat(prodx->GetElement(j), prodetax->GetElement(j), prodetaxflat->GetElement(j));
+				}
+			}
+		}
+	};
+
 	void ProductManifold::ProdElementToElement(const ProductElement *ProdElem, Element *Elem) const
 	{
 		const double *Prodspace;
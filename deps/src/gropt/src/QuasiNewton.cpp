@@ -12,8 +12,8 @@ namespace ROPTLIB{
 	void QuasiNewton::UpdateDataRBroydenFamily(void)
 	{
 		double yHy;
-		Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++;
-		Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++;
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++; TeleToc(TELE_TRANSPORT);
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++; TeleToc(TELE_TRANSPORT);
 		betay = Mani->Beta(x1, eta2);
 		//Mani->VectorLinearCombination(x2, 1.0 / betay, gf2, -1.0, zeta, y);
 		Mani->scalarVectorMinusVector(x2, 1.0 / betay, gf2, zeta, y);
@@ -55,8 +55,8 @@ namespace ROPTLIB{
 
 	void QuasiNewton::UpdateDataRBFGSSub(void)
 	{
-		Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++;
-		Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++;
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++; TeleToc(TELE_TRANSPORT);
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++; TeleToc(TELE_TRANSPORT);
 		betay = Mani->Beta(x1, eta2);
 		Mani->scalarVectorMinusVector(x2, 1.0 / betay, gf2, zeta, y);
 		inpyy = Mani->Metric(x2, y, y);
@@ -95,8 +95,8 @@ namespace ROPTLIB{
 
 	void QuasiNewton::UpdateDataRBFGS(void)
 	{
-		Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++;
-		Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++;
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++; TeleToc(TELE_TRANSPORT);
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++; TeleToc(TELE_TRANSPORT);
 		betay = Mani->Beta(x1, eta2);
 		Mani->scalarVectorMinusVector(x2, 1.0 / betay, gf2, zeta, y);
 		inpsy = Mani->Metric(x2, s, y);
@@ -153,8 +153,8 @@ namespace ROPTLIB{
 
 	void QuasiNewton::UpdateDataLRBFGSSub(void)
 	{
-		Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++;
-		Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++;
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++; TeleToc(TELE_TRANSPORT);
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++; TeleToc(TELE_TRANSPORT);
 		betay = Mani->Beta(x1, eta2);
 		Mani->scalarVectorMinusVector(x2, 1.0 / betay, gf2, zeta, y);
 
@@ -178,8 +178,8 @@ namespace ROPTLIB{
 				RHO[Currentlength] = rho;
 				for (integer i = 0; i < Currentlength; i++)
 				{
-					Mani->VectorTransport(x1, eta2, x2, Y[i], Y[i]); nVp++;
-					Mani->VectorTransport(x1, eta2, x2, S[i], S[i]); nVp++;
+					TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, Y[i], Y[i]); nVp++; TeleToc(TELE_TRANSPORT);
+					TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, S[i], S[i]); nVp++; TeleToc(TELE_TRANSPORT);
 				}
 				Currentlength++;
 			}
@@ -194,8 +194,8 @@ namespace ROPTLIB{
 					for (integer i = beginidx; i < beginidx + LengthSY - 1; i++)
 					{
 						idx = i % LengthSY;
-						Mani->VectorTransport(x1, eta2, x2, Y[idx], Y[idx]); nVp++;
-						Mani->VectorTransport(x1, eta2, x2, S[idx], S[idx]); nVp++;
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, Y[idx], Y[idx]); nVp++; TeleToc(TELE_TRANSPORT);
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, S[idx], S[idx]); nVp++; TeleToc(TELE_TRANSPORT);
 					}
 				}
 			isupdated = true;
@@ -215,6 +215,13 @@ namespace ROPTLIB{
 
 	void QuasiNewton::HvLRBFGS(Vector *v, Vector *result)
 	{
+		if (CompactForm)
+		{
+			HvLRBFGSCompact(v, result);
+			if (TransportFree)
+				Mani->Projection(x1, result, result);
+			return;
+		}
 		double *xi = new double[Currentlength];
 		double omega;
 		integer idx;
@@ -233,6 +240,9 @@ namespace ROPTLIB{
 			omega = RHO[idx] * Mani->Metric(x1, Y[idx], result);
 			Mani->scalarVectorAddVector(x1, xi[idx] - omega, S[idx], result, result);
 		}
+		/*The pairs are not at x1 if they are not transported, so bring the result back to the tangent space at x1*/
+		if (TransportFree)
+			Mani->Projection(x1, result, result);
 		delete[] xi;
 	};
 
@@ -241,6 +251,98 @@ namespace ROPTLIB{
 		return inpsy / inpyy;
 	};
 
+	void QuasiNewton::HvLRBFGSCompact(Vector *v, Vector *result)
+	{
+		/*H = gamma I + [S Y] M [S Y]^flat with M = [R^{-T} (D + gamma Y^flat Y) R^{-1}, -gamma R^{-T}; -R^{-1}, 0] in [BNS1994, (3.1)],
+		where R is the upper triangular part of S^flat Y and D its diagonal, with the pairs in the order they were stored.*/
+		integer m = Currentlength, L = LengthSY, twoL = 2 * LengthSY, length = v->Getlength(), inc = 1;
+		Mani->ScaleTimesVector(x1, gamma, v, result);
+		if (m == 0)
+			return;
+
+		double *ab = SYwork;
+		double *c = ab + twoL; // coefficients of [S Y]
+		double *q = c + twoL; // R^{-1} a
+		double *t = q + m;
+		double *R = t + m; // upper triangular R in the order of storage
+		double *YY = R + m * m; // Y^flat Y in the order of storage
+		integer si, sj; // the slots of the i-th and j-th stored pairs
+
+		char *transn = const_cast<char *> ("n"), *transt = const_cast<char *> ("t");
+		double one = 1, zero = 0;
+		Mani->ObtainEtaxFlat(x1, v, zeta);
+		// ab <- [S Y]^T zeta, details: http://www.netlib.org/lapack/explore-html/dc/da8/dgemv_8f.html
+		dgemv_(transt, &length, &twoL, &one, SYmat, &length, const_cast<double *> (zeta->ObtainReadData()), &inc, &zero, ab, &inc);
+
+		/*R(i, j) = g(s_i, y_j) for i <= j and YY(i, j) = g(y_i, y_j), both taken from the column of the newer pair*/
+		for (integer j = 0; j < m; j++)
+		{
+			sj = (beginidx + j) % L;
+			for (integer i = 0; i <= j; i++)
+			{
+				si = (beginidx + i) % L;
+				R[i + j * m] = SYinp[si + sj * twoL];
+				YY[i + j * m] = SYinp[L + si + sj * twoL];
+				YY[j + i * m] = YY[i + j * m];
+			}
+		}
+
+		/*q = R^{-1} a by backward substitution*/
+		for (integer i = m - 1; i >= 0; i--)
+		{
+			q[i] = ab[(beginidx + i) % L];
+			for (integer j = i + 1; j < m; j++)
+				q[i] -= R[i + j * m] * q[j];
+			q[i] /= R[i + i * m];
+		}
+		/*t = (D + gamma Y^flat Y) q - gamma b*/
+		for (integer i = 0; i < m; i++)
+		{
+			t[i] = R[i + i * m] * q[i] - gamma * ab[L + (beginidx + i) % L];
+			for (integer j = 0; j < m; j++)
+				t[i] += gamma * YY[i + j * m] * q[j];
+		}
+		/*t = R^{-T} t by forward substitution*/
+		for (integer i = 0; i < m; i++)
+		{
+			for (integer j = 0; j < i; j++)
+				t[i] -= R[j + i * m] * t[j];
+			t[i] /= R[i + i * m];
+		}
+
+		for (integer i = 0; i < twoL; i++)
+			c[i] = 0;
+		for (integer i = 0; i < m; i++)
+		{
+			si = (beginidx + i) % L;
+			c[si] = t[i];
+			c[L + si] = -gamma * q[i];
+		}
+		// result <- result + [S Y] c, details: http://www.netlib.org/lapack/explore-html/dc/da8/dgemv_8f.html
+		dgemv_(transn, &length, &twoL, &one, SYmat, &length, c, &inc, &one, result->ObtainWritePartialData(), &inc);
+	};
+
+	void QuasiNewton::UpdateCompactLRBFGS(integer idx, bool all)
+	{
+		integer length = Y[0]->Getlength(), L = LengthSY, twoL = 2 * LengthSY, inc = 1;
+		for (integer i = 0; i < L; i++)
+		{
+			if (i != idx && (!all || i >= Currentlength))
+				continue;
+			// SYmat(:, i) <- S[i], SYmat(:, L + i) <- Y[i], details: http://www.netlib.org/lapack/explore-html/da/d6c/dcopy_8f.html
+			dcopy_(&length, const_cast<double *> (S[i]->ObtainReadData()), &inc, SYmat + i * length, &inc);
+			dcopy_(&length, const_cast<double *> (Y[i]->ObtainReadData()), &inc, SYmat + (L + i) * length, &inc);
+		}
+
+		if (idx < 0)
+			return;
+		char *transt = const_cast<char *> ("t");
+		double one = 1, zero = 0;
+		Mani->ObtainEtaxFlat(x2, Y[idx], zeta);
+		// SYinp(:, idx) <- [S Y]^T zeta, details: http://www.netlib.org/lapack/explore-html/dc/da8/dgemv_8f.html
+		dgemv_(transt, &length, &twoL, &one, SYmat, &length, const_cast<double *> (zeta->ObtainReadData()), &inc, &zero, SYinp + idx * twoL, &inc);
+	};
+
 	void QuasiNewton::UpdateDataLRBFGS(void)
 	{
 #ifdef TESTEUCPOSSPCD
@@ -262,8 +364,8 @@ namespace ROPTLIB{
 			}
 		}
 #endif
-		Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++;
-		Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++;
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta2, s); nV++; TeleToc(TELE_TRANSPORT);
+		TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nVp++; TeleToc(TELE_TRANSPORT);
 		betay = Mani->Beta(x1, eta2);
 		Mani->scalarVectorMinusVector(x2, 1.0 / betay, gf2, zeta, y);
 		PreConditioner(x2, y, Py);
@@ -280,37 +382,43 @@ namespace ROPTLIB{
 				y->CopyTo(Y[Currentlength]);
 				s->CopyTo(S[Currentlength]);
 				RHO[Currentlength] = rho;
-				for (integer i = 0; i < Currentlength; i++)
+				for (integer i = 0; i < Currentlength && !TransportFree; i++)
 				{
-					Mani->VectorTransport(x1, eta2, x2, Y[i], Y[i]); nVp++;
-					Mani->VectorTransport(x1, eta2, x2, S[i], S[i]); nVp++;
+					TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, Y[i], Y[i]); nVp++; TeleToc(TELE_TRANSPORT);
+					TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, S[i], S[i]); nVp++; TeleToc(TELE_TRANSPORT);
 				}
 				Currentlength++;
+				if (CompactForm)
+					UpdateCompactLRBFGS(Currentlength - 1, !TransportFree);
 			}
 			else
 				if (LengthSY > 0)
 				{
-					integer idx;
+					integer idx, newidx = beginidx;
 					y->CopyTo(Y[beginidx]);
 					s->CopyTo(S[beginidx]);
 					RHO[beginidx] = rho;
 					beginidx = (++beginidx) % LengthSY;
-					for (integer i = beginidx; i < beginidx + LengthSY - 1; i++)
+					for (integer i = beginidx; i < beginidx + LengthSY - 1 && !TransportFree; i++)
 					{
 						idx = i % LengthSY;
-						Mani->VectorTransport(x1, eta2, x2, Y[idx], Y[idx]); nVp++;
-						Mani->VectorTransport(x1, eta2, x2, S[idx], S[idx]); nVp++;
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, Y[idx], Y[idx]); nVp++; TeleToc(TELE_TRANSPORT);
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, S[idx], S[idx]); nVp++; TeleToc(TELE_TRANSPORT);
 					}
+					if (CompactForm)
+						UpdateCompactLRBFGS(newidx, !TransportFree);
 				}
 			isupdated = true;
 		}
 		else
 		{
-			for (integer i = 0; i < Currentlength; i++)
+			for (integer i = 0; i < Currentlength && !TransportFree; i++)
 			{
-				Mani->VectorTransport(x1, eta2, x2, Y[i], Y[i]); nVp++;
-				Mani->VectorTransport(x1, eta2, x2, S[i], S[i]); nVp++;
+				TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, Y[i], Y[i]); nVp++; TeleToc(TELE_TRANSPORT);
+				TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, S[i], S[i]); nVp++; TeleToc(TELE_TRANSPORT);
 			}
+			if (CompactForm && !TransportFree)
+				UpdateCompactLRBFGS(-1, true);
 			isupdated = false;
 		}
 	};
@@ -323,7 +431,7 @@ namespace ROPTLIB{
 	void QuasiNewton::UpdateDataRWRBFGS(void)
 	{
 		eta2->CopyTo(s);
-		Mani->coTangentVector(x1, eta2, x2, gf2, y); nV++;
+		TeleTic(TELE_TRANSPORT); Mani->coTangentVector(x1, eta2, x2, gf2, y); nV++; TeleToc(TELE_TRANSPORT);
 		Mani->VectorMinusVector(x1, y, gf1, y);
 		inpsy = Mani->Metric(x1, s, y);
 		if (isconvex && iter == 1 && inpsy > 0)
@@ -359,9 +467,9 @@ namespace ROPTLIB{
 	{
 		double denorminator, norm2ymBs;
 		double mintolsq = std::numeric_limits<double>::epsilon();
-		Prob->Grad(x2, gf2); ng++;
+		TeleTic(TELE_GRAD); Prob->Grad(x2, gf2); ng++; TeleToc(TELE_GRAD);
 		eta2->CopyTo(s);
-		Mani->InverseVectorTransport(x1, eta2, x2, gf2, eta1); nV++;
+		TeleTic(TELE_TRANSPORT); Mani->InverseVectorTransport(x1, eta2, x2, gf2, eta1); nV++; TeleToc(TELE_TRANSPORT);
 		Mani->VectorMinusVector(x1, eta1, gf1, y);
 		Mani->VectorMinusVector(x1, y, zeta, zeta);
 		denorminator = Mani->Metric(x1, s, zeta);
@@ -416,9 +524,9 @@ namespace ROPTLIB{
 		double denorminator, norm2ymBs;
 		double mintolsq = std::numeric_limits<double>::epsilon();
 		double mintol = sqrt(mintolsq);
-		Prob->Grad(x2, gf2); ng++;
+		TeleTic(TELE_GRAD); Prob->Grad(x2, gf2); ng++; TeleToc(TELE_GRAD);
 		eta2->CopyTo(s);
-		Mani->InverseVectorTransport(x1, eta2, x2, gf2, eta1); nV++;
+		TeleTic(TELE_TRANSPORT); Mani->InverseVectorTransport(x1, eta2, x2, gf2, eta1); nV++; TeleToc(TELE_TRANSPORT);
 		Mani->VectorMinusVector(x1, eta1, gf1, y);
 		Mani->VectorMinusVector(x1, y, zeta, zeta);
 		denorminator = Mani->Metric(x1, s, zeta);
@@ -504,6 +612,16 @@ namespace ROPTLIB{
 				LengthSY = static_cast<integer> (iter->second);
 			}
 			else
+			if (iter->first == static_cast<std::string> ("TransportFree"))
+			{
+				TransportFree = ((static_cast<integer> (iter->second)) != 0);
+			}
+			else
+			if (iter->first == static_cast<std::string> ("CompactForm"))
+			{
+				CompactForm = ((static_cast<integer> (iter->second)) != 0);
+			}
+			else
 			if (iter->first == static_cast<std::string> ("nu"))
 			{
 				nu = iter->second;
@@ -68,6 +68,14 @@ namespace ROPTLIB{
 		delete tildeH;
 	};
 
+	bool RBFGS::Reset(const Problem *prob, const Variable *initialx)
+	{
+		if (!SolversLS::Reset(prob, initialx))
+			return false;
+		H->ScaledIdOPE();
+		return true;
+	};
+
 	void RBFGS::CheckParams(void)
 	{
 		SolversLS::CheckParams();
@@ -80,27 +80,27 @@ namespace ROPTLIB{
 			if (RCGmethod == FLETCHER_REEVES)
 			{
 				sigma = Mani->Metric(x2, gf2, Pgf2) / Mani->Metric(x1, gf1, Pgf1);
-				Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nV++;
+				TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nV++; TeleToc(TELE_TRANSPORT);
 			}
 			else
 				if (RCGmethod == POLAK_RIBIERE_MOD)
 				{
-					Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nV++;
+					TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nV++; TeleToc(TELE_TRANSPORT);
 					Mani->VectorMinusVector(x2, gf2, zeta, zeta);
 					sigma = Mani->Metric(x2, zeta, Pgf2) / Mani->Metric(x1, gf1, Pgf1);
 					if (LineSearch_LS == STRONGWOLFE && sigma <= 0)
 						sigma = 0;
 					else
 					{
-						Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nVp++;
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nVp++; TeleToc(TELE_TRANSPORT);
 					}
 				}
 				else
 					if (RCGmethod == HESTENES_STIEFEL)
 					{
 						double numerator, denominator;
-						Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nV++;
-						Mani->VectorTransport(x1, eta2, x2, gf1, eta1); nVp++;
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nV++; TeleToc(TELE_TRANSPORT);
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, eta1); nVp++; TeleToc(TELE_TRANSPORT);
 						Mani->VectorMinusVector(x2, gf2, eta1, eta1);
 						numerator = Mani->Metric(x2, eta1, Pgf2);
 						denominator = Mani->Metric(x2, zeta, eta1);
@@ -110,7 +110,7 @@ namespace ROPTLIB{
 						if (RCGmethod == FR_PR)
 						{
 							double sigmaFR, sigmaPR;
-							Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nV++;
+							TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, zeta); nV++; TeleToc(TELE_TRANSPORT);
 							Mani->VectorMinusVector(x2, gf2, zeta, zeta);
 							sigmaPR = Mani->Metric(x2, zeta, Pgf2) / Mani->Metric(x1, gf1, Pgf1);
 							sigmaFR = Mani->Metric(x2, gf2, Pgf2) / Mani->Metric(x1, gf1, Pgf1);
@@ -121,14 +121,14 @@ namespace ROPTLIB{
 									sigma = sigmaFR;
 								else
 									sigma = sigmaPR;
-							Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nVp++;
+							TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nVp++; TeleToc(TELE_TRANSPORT);
 						}
 						else
 							if (RCGmethod == DAI_YUAN)
 							{
-								Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nV++;
+								TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nV++; TeleToc(TELE_TRANSPORT);
 
-								Mani->VectorTransport(x1, eta2, x2, gf1, eta1); nVp++;
+								TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, eta1); nVp++; TeleToc(TELE_TRANSPORT);
 								Mani->VectorMinusVector(x2, gf2, eta1, eta1);
 								sigma = Mani->Metric(x2, gf2, Pgf2) / Mani->Metric(x2, zeta, eta1);
 							}
@@ -136,9 +136,9 @@ namespace ROPTLIB{
 								if (RCGmethod == HAGER_ZHANG)
 								{
 									double temp1, temp2;
-									Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nV++;
+									TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, eta1, zeta); nV++; TeleToc(TELE_TRANSPORT);
 
-									Mani->VectorTransport(x1, eta2, x2, gf1, eta1); nVp++;
+									TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gf1, eta1); nVp++; TeleToc(TELE_TRANSPORT);
 									Mani->VectorMinusVector(x2, gf2, eta1, eta1);
 									temp1 = Mani->Metric(x2, eta1, zeta);
 									temp2 = -2.0 * Mani->Metric(x2, eta1, eta1) / temp1;
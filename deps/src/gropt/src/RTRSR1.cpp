@@ -81,6 +81,14 @@ namespace ROPTLIB{
 		tildeB->CopyTo(B);
 	};
 
+	bool RTRSR1::Reset(const Problem *prob, const Variable *initialx)
+	{
+		if (!SolversTR::Reset(prob, initialx))
+			return false;
+		B->ScaledIdOPE();
+		return true;
+	};
+
 	void RTRSR1::CheckParams(void)
 	{
 		SolversTR::CheckParams();
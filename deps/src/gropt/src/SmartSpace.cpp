@@ -1,5 +1,6 @@
 
 #include "SmartSpace.h"
+#include "MemoryPool.h"
 
 /*Define the namespace*/
 namespace ROPTLIB{
@@ -27,7 +28,7 @@ namespace ROPTLIB{
 		if (sharedtimes == nullptr)
 		{
 			NewMemory();
-			sharedtimes = new integer;
+			sharedtimes = MemoryPool::NewCounter();
 			*sharedtimes = 1;
 		}
 		else
@@ -35,7 +36,7 @@ namespace ROPTLIB{
 			{
 				NewMemory();
 				(*sharedtimes)--;
-				sharedtimes = new integer;
+				sharedtimes = MemoryPool::NewCounter();
 				*sharedtimes = 1;
 			}
 	};
@@ -45,7 +46,7 @@ namespace ROPTLIB{
 		if (sharedtimes == nullptr)
 		{
 			NewMemory();
-			sharedtimes = new integer;
+			sharedtimes = MemoryPool::NewCounter();
 			*sharedtimes = 1;
 		}
 		else
@@ -54,7 +55,7 @@ namespace ROPTLIB{
 				double *ptr = Space;
 				NewMemory();
 				(*sharedtimes)--;
-				sharedtimes = new integer;
+				sharedtimes = MemoryPool::NewCounter();
 				*sharedtimes = 1;
 
 				integer N = length, inc = 1;
@@ -63,19 +64,23 @@ namespace ROPTLIB{
 			}
 	};
 
-	void SmartSpace::RandUnform(double start, double end)
+	void SmartSpace::RandUnform(double start, double end, RandGenContext *ctx)
 	{
+		if (ctx == nullptr)
+			ctx = genranddefault();
 		NewMemoryOnWrite();
 		double ell = end - start;
 		for (integer i = 0; i < length; i++)
-			Space[i] = genrandreal() * ell + start;
+			Space[i] = genrandreal(ctx) * ell + start;
 	};
 
-	void SmartSpace::RandGaussian(double mean, double variance)
+	void SmartSpace::RandGaussian(double mean, double variance, RandGenContext *ctx)
 	{
+		if (ctx == nullptr)
+			ctx = genranddefault();
 		NewMemoryOnWrite();
 		for (integer i = 0; i < length; i++)
-			Space[i] = (genrandnormal() + mean) * variance;
+			Space[i] = (genrandnormal(ctx) + mean) * variance;
 	};
 
 	void SmartSpace::CopyTo(SmartSpace *eta) const
@@ -107,8 +112,8 @@ namespace ROPTLIB{
                 dcopy_(&N, Space, &inc, eta->Space, &inc);
              else
              {
- 				delete eta->sharedtimes; eta->sharedtimes = nullptr;
- 				delete[] eta->Space; eta->Space = nullptr;
+ 				MemoryPool::DeleteCounter(eta->sharedtimes); eta->sharedtimes = nullptr;
+ 				MemoryPool::DeleteDoubles(eta->Space, eta->length); eta->Space = nullptr;
              }
 			return;
 		}
@@ -124,8 +129,8 @@ namespace ROPTLIB{
 #ifdef CHECKMEMORYDELETED
 				(*CheckMemoryDeleted)[eta->sharedtimes] = *(eta->sharedtimes);
 #endif
-				delete eta->sharedtimes; eta->sharedtimes = nullptr;
-				delete[] eta->Space; eta->Space = nullptr;
+				MemoryPool::DeleteCounter(eta->sharedtimes); eta->sharedtimes = nullptr;
+				MemoryPool::DeleteDoubles(eta->Space, eta->length); eta->Space = nullptr;
 			}
 
 		if (sharedtimes != nullptr)
@@ -147,7 +152,7 @@ namespace ROPTLIB{
 	void SmartSpace::NewMemory(void)
 	{
 		try{
-			Space = new double[length];
+			Space = MemoryPool::NewDoubles(length);
 		}
 		catch (std::bad_alloc exception)
 		{
@@ -186,8 +191,8 @@ namespace ROPTLIB{
 			(*sharedtimes)--;
 			if (*sharedtimes == 0 && Space != nullptr)
 			{
-				delete sharedtimes; sharedtimes = nullptr;
-				delete[] Space; Space = nullptr;
+				MemoryPool::DeleteCounter(sharedtimes); sharedtimes = nullptr;
+				MemoryPool::DeleteDoubles(Space, length); Space = nullptr;
 			}
 		}
 	};
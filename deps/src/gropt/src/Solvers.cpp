@@ -31,6 +31,23 @@ namespace ROPTLIB{
 			printf("nV(nVp):%d(%d),", nV, nVp);
 	};
 
+	void Solvers::TeleRecord(double f, double step)
+	{
+		if (Tele == nullptr || Tele->records == nullptr || Tele->length >= Tele->capacity)
+			return;
+		double *record = Tele->records + Tele->length * TELERECORDLENGTH;
+		record[0] = static_cast<double> (iter);
+		record[1] = static_cast<double>(getTickCount() - starttime) / CLK_PS;
+		record[2] = f;
+		record[3] = ngf;
+		record[4] = step;
+		record[5] = static_cast<double> (nf);
+		record[6] = static_cast<double> (ng);
+		record[7] = static_cast<double> (nR);
+		record[8] = static_cast<double> (nV + nVp);
+		Tele->length++;
+	};
+
 	void Solvers::PrintInfo(void)
 	{
 		printf("\n");
@@ -104,7 +121,7 @@ namespace ROPTLIB{
 				{
 					for (integer i = 0; i < Currentlengthgfs; i++)
 					{
-						Mani->VectorTransport(x1, eta2, x2, gfs[i], gfs[i]); nVp++;
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gfs[i], gfs[i]); nVp++; TeleToc(TELE_TRANSPORT);
 					}
 					gf2->CopyTo(gfs[Currentlengthgfs]);
 					Currentlengthgfs++;
@@ -117,7 +134,7 @@ namespace ROPTLIB{
 					for (integer i = idxgfs; i < idxgfs + Lengthgfs - 1; i++)
 					{
 						idx = i % Lengthgfs;
-						Mani->VectorTransport(x1, eta2, x2, gfs[idx], gfs[idx]); nVp++;
+						TeleTic(TELE_TRANSPORT); Mani->VectorTransport(x1, eta2, x2, gfs[idx], gfs[idx]); nVp++; TeleToc(TELE_TRANSPORT);
 					}
 				}
 			}
@@ -245,8 +262,10 @@ namespace ROPTLIB{
 	void Solvers::SetDefaultParams()
 	{
 		nf = 0; ng = 0; nV = 0; nVp = 0; nR = 0; nH = 0; lengthSeries = 0;
+		ProbUseGrad = Prob->GetUseGrad(); ProbUseHess = Prob->GetUseHess();
 		timeSeries = nullptr; funSeries = nullptr; gradSeries = nullptr; distSeries = nullptr;
 		StopPtr = nullptr;
+		Tele = nullptr;
 
 		Stop_Criterion = GRAD_F_0;
 		TimeBound = 60 * 60 * 24 * 365;//one year;
@@ -264,6 +283,33 @@ namespace ROPTLIB{
 		subprobtimes = 0;
 	};
 
+	bool Solvers::Reset(const Problem *prob, const Variable *initialx)
+	{
+		const Vector *EMPTYETA;
+		if (prob->GetDomain()->GetIsIntrinsic())
+			EMPTYETA = prob->GetDomain()->GetEMPTYINTR();
+		else
+			EMPTYETA = prob->GetDomain()->GetEMPTYEXTR();
+		if (initialx->Getlength() != x1->Getlength() || EMPTYETA->Getlength() != gf1->Getlength())
+		{
+			printf("Error: the domain of the problem does not match the solver, the solver is not reset!\n");
+			return false;
+		}
+
+		Mani = prob->GetDomain();
+		Prob = prob;
+		prob->SetUseGrad(ProbUseGrad);
+		prob->SetUseHess(ProbUseHess);
+		initialx->CopyTo(x1);
+		x2->RemoveAllFromTempData();
+		nf = 0; ng = 0; nV = 0; nVp = 0; nR = 0; nH = 0;
+		nsubgf = -1;
+		Currentlengthgfs = 0;
+		idxgfs = 0;
+		subprobtimes = 0;
+		return true;
+	};
+
 	Solvers::~Solvers(void)
 	{
 		delete eta1;
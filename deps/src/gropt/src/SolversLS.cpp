@@ -15,13 +15,13 @@ namespace ROPTLIB{
 		ChooseLinesearch();
 
 		LSstatus = SUCCESS;
-		f1 = Prob->f(x1); nf++;
+		f1 = FuncGrad(x1, gf1); nf++; ng++;
 		f2 = f1;
-		Prob->Grad(x1, gf1); ng++;
 		ngf0 = sqrt(Mani->Metric(x1, gf1, gf1));
 		ngf = ngf0;
 		newslope = 0;
 		iter = 0;
+		TeleRecord(f1, 0);
 		if (Debug >= ITERRESULT)
 		{
 			printf("i:%d,f:%.3e,|gf|:%.3e,\n", iter, f1, ngf);
@@ -31,12 +31,6 @@ namespace ROPTLIB{
 			distSeries[iter] = ((soln == nullptr) ? 0 : Mani->Dist(x1, soln));
 		}
 		bool isstop = IsStopped();
-		/*If the intrinsic representation is used, then exeta1 and exeta2 are used to store the extrinsic representations of eta1 and eta2 respectively*/
-		if (Prob->GetDomain()->GetIsIntrinsic())
-		{
-			exeta1 = Prob->GetDomain()->GetEMPTYEXTR()->ConstructEmpty();
-			exeta2 = Prob->GetDomain()->GetEMPTYEXTR()->ConstructEmpty();
-		}
 
 		/*Start the loop*/
 		while ((((! isstop) && iter < Max_Iteration) || iter < Min_Iteration) && LSstatus == SUCCESS)
@@ -52,6 +46,7 @@ namespace ROPTLIB{
 				Prob->GetDomain()->ObtainExtr(x1, eta1, exeta1);
 			}
 
+			TeleTic(TELE_LINESEARCH);
 			/*If accurate enough, then a fixed stepsize is chosen.*/
 			if (ngf / (ngf0 + Tolerance) < Accuracy)
 			{
@@ -59,8 +54,7 @@ namespace ROPTLIB{
 					stepsize = Finalstepsize;
 				else
 					stepsize = initiallength;
-				f2 = h();
-				Prob->Grad(x2, gf2); ng++;
+				f2 = hg();
 			}
 			else
 			{
@@ -85,8 +79,7 @@ namespace ROPTLIB{
 					}
 					else
 					{
-						f2 = h();
-						Prob->Grad(x2, gf2); ng++;
+						f2 = hg();
 					}
 				}
 				else
@@ -94,6 +87,7 @@ namespace ROPTLIB{
 					(this->*Linesearch)();
 				}
 			}
+			TeleToc(TELE_LINESEARCH);
 			/*Output debug information if necessary.*/
 			if (LSstatus < SUCCESS && Debug >= FINALRESULT)
 			{
@@ -108,6 +102,7 @@ namespace ROPTLIB{
 
 			/*norm of the gradient at x2*/
 			ngf = sqrt(Mani->Metric(x2, gf2, gf2));
+			TeleRecord(f2, stepsize);
 
 			if (Debug >= ITERRESULT)
 			{
@@ -135,11 +130,6 @@ namespace ROPTLIB{
 				pre_funs.pop_back();
 			f1 = f2;
 		}
-		if (Prob->GetDomain()->GetIsIntrinsic())
-		{
-			delete exeta1;
-			delete exeta2;
-		}
 		ComTime = static_cast<double>(getTickCount() - starttime) / CLK_PS;
 		if (Debug >= ITERRESULT)
 			lengthSeries = iter + 1;
@@ -449,7 +439,13 @@ namespace ROPTLIB{
 	void SolversLS::LinesearchArmijo(void)
 	{
 		LSstatus = SUCCESS;
-		f2 = h();
+		// If the problem evaluates the gradient with the cost function at little extra cost, it is done at the
+		// first trial point, which is accepted in most iterations. gf2 is recomputed only if the step is reduced.
+		bool isgf2 = Prob->HasFuncGrad();
+		if (isgf2)
+			f2 = hg();
+		else
+			f2 = h();
 		double maxpref = f1;
 		std::list<double>::iterator j = pre_funs.begin();
 		for (integer i = 0; i < Num_pre_funs && j != pre_funs.end(); i++, j++)
@@ -475,8 +471,12 @@ namespace ROPTLIB{
 					break;
 				}
 				f2 = h();
+				isgf2 = false;
+			}
+			if (!isgf2)
+			{
+				TeleTic(TELE_GRAD); Prob->Grad(x2, gf2); ng++; TeleToc(TELE_GRAD);
 			}
-			Prob->Grad(x2, gf2); ng++;
 			return;
 		}
 
@@ -490,6 +490,7 @@ namespace ROPTLIB{
 			f2pre = f2;
 			prestepsize2 = prestepsize;
 			f2 = h();
+			isgf2 = false;
 			prestepsize = stepsize;
 		}
 
@@ -520,9 +521,13 @@ namespace ROPTLIB{
 			f2pre = f2;
 			prestepsize2 = prestepsize;
 			f2 = h();
+			isgf2 = false;
 			prestepsize = stepsize;
 		}
-		Prob->Grad(x2, gf2); ng++;
+		if (!isgf2)
+		{
+			TeleTic(TELE_GRAD); Prob->Grad(x2, gf2); ng++; TeleToc(TELE_GRAD);
+		}
 	};
 
 	void SolversLS::LinesearchExact(void)
@@ -595,21 +600,57 @@ namespace ROPTLIB{
 		{
 			Mani->ScaleTimesVector(x1, stepsize, exeta1, exeta2);
 			Mani->SetIsIntrApproach(false);
-			Mani->Retraction(x1, exeta2, x2, stepsize); nR++;
+			TeleTic(TELE_RETRACTION); Mani->Retraction(x1, exeta2, x2, stepsize); nR++; TeleToc(TELE_RETRACTION);
 			Mani->SetIsIntrApproach(true);
 		}
 		else
 		{
-			Mani->Retraction(x1, eta2, x2, stepsize); nR++;
+			TeleTic(TELE_RETRACTION); Mani->Retraction(x1, eta2, x2, stepsize); nR++; TeleToc(TELE_RETRACTION);
 		}
 		nf++;
-		return Prob->f(x2);
+		TeleTic(TELE_F);
+		double result = Prob->f(x2);
+		TeleToc(TELE_F);
+		return result;
+	};
+
+	double SolversLS::hg(void)
+	{
+		Mani->ScaleTimesVector(x1, stepsize, eta1, eta2);
+		if (Mani->GetIsIntrinsic())
+		{
+			Mani->ScaleTimesVector(x1, stepsize, exeta1, exeta2);
+			Mani->SetIsIntrApproach(false);
+			TeleTic(TELE_RETRACTION); Mani->Retraction(x1, exeta2, x2, stepsize); nR++; TeleToc(TELE_RETRACTION);
+			Mani->SetIsIntrApproach(true);
+		}
+		else
+		{
+			TeleTic(TELE_RETRACTION); Mani->Retraction(x1, eta2, x2, stepsize); nR++; TeleToc(TELE_RETRACTION);
+		}
+		nf++; ng++;
+		return FuncGrad(x2, gf2);
+	};
+
+	double SolversLS::FuncGrad(Variable *x, Vector *gf)
+	{
+		double result;
+		if (Prob->HasFuncGrad())
+		{
+			TeleTic(TELE_FUNCGRAD); result = Prob->FuncGrad(x, gf); TeleToc(TELE_FUNCGRAD);
+		}
+		else
+		{ // the default Problem::FuncGrad calls f and Grad, which are timed separately
+			TeleTic(TELE_F); result = Prob->f(x); TeleToc(TELE_F);
+			TeleTic(TELE_GRAD); Prob->Grad(x, gf); TeleToc(TELE_GRAD);
+		}
+		return result;
 	};
 
 	double SolversLS::dh(void)
 	{
-		Prob->Grad(x2, gf2); ng++;
-		Mani->DiffRetraction(x1, eta2, x2, eta1, zeta, true); nV++;
+		TeleTic(TELE_GRAD); Prob->Grad(x2, gf2); ng++; TeleToc(TELE_GRAD);
+		TeleTic(TELE_TRANSPORT); Mani->DiffRetraction(x1, eta2, x2, eta1, zeta, true); nV++; TeleToc(TELE_TRANSPORT);
 		return Mani->Metric(x2, gf2, zeta);
 	};
 
@@ -759,11 +800,27 @@ namespace ROPTLIB{
 	void SolversLS::SetProbX(const Problem *prob, const Variable *initialx, const Variable *insoln)
 	{
 		Solvers::SetProbX(prob, initialx, insoln);
-		const Vector *EMPTYETA;
+		/*If the intrinsic representation is used, then exeta1 and exeta2 are used to store the extrinsic representations of eta1 and eta2 respectively*/
+		exeta1 = nullptr;
+		exeta2 = nullptr;
 		if (prob->GetDomain()->GetIsIntrinsic())
-			EMPTYETA = prob->GetDomain()->GetEMPTYINTR();
-		else
-			EMPTYETA = prob->GetDomain()->GetEMPTYEXTR();
+		{
+			exeta1 = prob->GetDomain()->GetEMPTYEXTR()->ConstructEmpty();
+			exeta2 = prob->GetDomain()->GetEMPTYEXTR()->ConstructEmpty();
+		}
+	};
+
+	bool SolversLS::Reset(const Problem *prob, const Variable *initialx)
+	{
+		if (prob->GetDomain()->GetIsIntrinsic() && (exeta1 == nullptr || exeta1->Getlength() != prob->GetDomain()->GetEMPTYEXTR()->Getlength()))
+		{
+			printf("Error: the domain of the problem does not match the solver, the solver is not reset!\n");
+			return false;
+		}
+		if (!Solvers::Reset(prob, initialx))
+			return false;
+		pre_BBs.clear();
+		return true;
 	};
 
 	void SolversLS::SetDefaultParams()
@@ -795,6 +852,10 @@ namespace ROPTLIB{
 
 	SolversLS::~SolversLS(void)
 	{
+		if (exeta1 != nullptr)
+			delete exeta1;
+		if (exeta2 != nullptr)
+			delete exeta2;
 		delete[] LSstatusSetnames;
 	};
 
@@ -830,7 +891,7 @@ namespace ROPTLIB{
 					}
 					if (stepsize >= Maxstepsize) // stepsize == Maxstepsize
 					{
-						Prob->Grad(x2, gf2); ng++;
+						TeleTic(TELE_GRAD); Prob->Grad(x2, gf2); ng++; TeleToc(TELE_GRAD);
 						LSstatus = MAXSTEPSIZE;
 						return;
 					}
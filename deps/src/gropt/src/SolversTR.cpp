@@ -12,9 +12,9 @@ namespace ROPTLIB{
 		starttime = getTickCount();
 		double sqeps = sqrt(std::numeric_limits<double>::epsilon());
 
-		f1 = Prob->f(x1); nf++;
+		TeleTic(TELE_F); f1 = Prob->f(x1); nf++; TeleToc(TELE_F);
 		f2 = f1;
-		Prob->Grad(x1, gf1); ng++;
+		TeleTic(TELE_GRAD); Prob->Grad(x1, gf1); ng++; TeleToc(TELE_GRAD);
 
 		ngf0 = sqrt(Mani->Metric(x1, gf1, gf1));
 		ngf = ngf0;
@@ -28,13 +28,14 @@ namespace ROPTLIB{
 			distSeries[iter] = ((soln == nullptr) ? 0 : Mani->Dist(x1, soln));
 		}
 		Delta = initial_Delta;
+		TeleRecord(f1, Delta);
 		bool isstop = IsStopped();
 		while (((! isstop) && iter < Max_Iteration) || iter < Min_Iteration)
 		{
 			InitialVector(); // Obtain initial guess, eta1, for local model
 			tCG_TR(); // obtain eta2
-			Mani->Retraction(x1, eta2, x2, Delta);	nR++;
-			f2 = Prob->f(x2); nf++;
+			TeleTic(TELE_RETRACTION); Mani->Retraction(x1, eta2, x2, Delta); nR++; TeleToc(TELE_RETRACTION);
+			TeleTic(TELE_F); f2 = Prob->f(x2); nf++; TeleToc(TELE_F);
 			HessianEta(eta2, zeta); nH++; // Hessian * eta2
 
 			Mani->scalarVectorAddVector(x1, 0.5, zeta, gf1, eta1);
@@ -92,6 +93,7 @@ namespace ROPTLIB{
 					PrintInfo(); // Output information specific to Algorithms
 				}
 			}
+			TeleRecord(f1, Delta);
 
 			if (Debug >= ITERRESULT)
 			{
@@ -263,7 +265,7 @@ namespace ROPTLIB{
 
 	void SolversTR::Acceptence(void)
 	{
-		Prob->Grad(x2, gf2); ng++;
+		TeleTic(TELE_GRAD); Prob->Grad(x2, gf2); ng++; TeleToc(TELE_GRAD);
 	};
 
 	void SolversTR::SetProbX(const Problem *prob, const Variable *initialx, const Variable *insoln)
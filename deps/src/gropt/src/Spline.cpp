@@ -9,10 +9,10 @@ namespace ROPTLIB{
 		int i, nn;
 		double *d, *ud, *ld, *vec, *s;
 		nn = n - 1;
-		d = new double[5 * nn - 1];
+		d = new double[5 * nn + 1]; // d, ud, ld and vec have nn entries including the periodic corners, s has nn + 1
 		ud = d + nn;
-		ld = ud + (nn - 1);
-		vec = ld + (nn - 1);
+		ld = ud + nn;
+		vec = ld + nn;
 		s = vec + nn;
 		if (fabs(Y[0] - Y[nn]) > sqrt(std::numeric_limits<double>::epsilon()))
 		{
@@ -54,10 +54,10 @@ namespace ROPTLIB{
 		double *d, *ud, *ld, *vec, *s;
 		double hi;
 		nn = n - 1;
-		d = new double[5 * nn - 1];
+		d = new double[5 * nn + 1]; // d, ud, ld and vec have nn entries including the periodic corners, s has nn + 1
 		ud = d + nn;
-		ld = ud + (nn - 1);
-		vec = ld + (nn - 1);
+		ld = ud + nn;
+		vec = ld + nn;
 		s = vec + nn;
 		if (fabs(Y[0] - Y[nn]) > sqrt(std::numeric_limits<double>::epsilon()))
 		{
@@ -402,4 +402,83 @@ namespace ROPTLIB{
 		output = dericoefs[0 * nn + i] * t + dericoefs[1 * nn + i];
 		return output;
 	};
+
+	/* the interval of t on uniform knots as found by ValSplineUniform, t is shifted to the interval */
+	static inline integer IntervalUniform(integer nn, double h, double &t)
+	{
+		integer i = static_cast<integer> (t / h);
+		while (t - i * h >= -std::numeric_limits<double>::epsilon())
+			i++;
+		i--;
+		i = (i < 0) ? 0 : i;
+		i = (i > nn - 1) ? nn - 1 : i;
+		t -= i * h;
+		return i;
+	};
+
+	void Spline::InterleaveUniform(const double *coefs, int N, int d, int order, double *icoefs)
+	{
+		integer nn = N - 1;
+		for (integer j = 0; j < d; j++)
+		{
+			const double *coefsj = coefs + j * order * nn;
+			for (integer k = 0; k < order; k++)
+			{
+				for (integer i = 0; i < nn; i++)
+					icoefs[(i * d + j) * order + k] = coefsj[k * nn + i];
+			}
+		}
+	};
+
+	void Spline::ValSplineUniformBatch(const double *icoefs, int N, int d, double h, const double *t, int m, double *result)
+	{
+		integer nn = N - 1;
+		for (integer i = 0; i < m; i++)
+		{
+			double ti = t[i];
+			const double *c = icoefs + IntervalUniform(nn, h, ti) * d * 4;
+			for (integer j = 0; j < d; j++, c += 4)
+				result[i + j * m] = ((c[0] * ti + c[1]) * ti + c[2]) * ti + c[3];
+		}
+	};
+
+	void Spline::ValSplineAndFirstDeriUniformBatch(const double *icoefs, int N, int d, double h, const double *t, int m,
+		double *result, double *deriresult)
+	{
+		integer nn = N - 1;
+		for (integer i = 0; i < m; i++)
+		{
+			double ti = t[i];
+			const double *c = icoefs + IntervalUniform(nn, h, ti) * d * 4;
+			for (integer j = 0; j < d; j++, c += 4)
+			{
+				result[i + j * m] = ((c[0] * ti + c[1]) * ti + c[2]) * ti + c[3];
+				deriresult[i + j * m] = (c[0] * 3 * ti + c[1] * 2) * ti + c[2];
+			}
+		}
+	};
+
+	void Spline::ValFirstDeriUniformBatch(const double *icoefs, int N, int d, double h, const double *t, int m, double *result)
+	{
+		integer nn = N - 1;
+		for (integer i = 0; i < m; i++)
+		{
+			double ti = t[i];
+			const double *c = icoefs + IntervalUniform(nn, h, ti) * d * 3;
+			for (integer j = 0; j < d; j++, c += 3)
+				result[i + j * m] = (c[0] * ti + c[1]) * ti + c[2];
+		}
+	};
+
+	void Spline::ValSecondDeriUniformBatch(const double *icoefs, int N, int d, double h, const double *t, int m, double *result)
+	{
+		integer nn = N - 1;
+		for (integer i = 0; i < m; i++)
+		{
+			double ti = t[i];
+			const double *c = icoefs + IntervalUniform(nn, h, ti) * d * 2;
+			for (integer j = 0; j < d; j++, c += 2)
+				result[i + j * m] = c[0] * ti + c[1];
+		}
+	};
 }; /*end of ROPTLIB namespace*/
@@ -4,24 +4,109 @@
 
 #include "randgen.h"
 
+static inline uint64_t rotl(const uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/* next number of xoshiro256** */
+static inline uint64_t genrandnext(RandGenContext *ctx)
+{
+	uint64_t *s = ctx->s;
+	const uint64_t result = rotl(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+	return result;
+}
+
+RandGenContext *genranddefault()
+{
+	static thread_local RandGenContext defaultctx;
+	static thread_local bool initialized = false;
+	if (!initialized)
+	{
+		genrandseed(&defaultctx, 0);
+		initialized = true;
+	}
+	return &defaultctx;
+}
+
 void genrandseed(unsigned int s)
 {
-    srand(s);
+	genrandseed(genranddefault(), s);
+}
+
+void genrandseed(RandGenContext *ctx, unsigned int s)
+{
+	/* fill the state by splitmix64 such that it is never all zero */
+	uint64_t x = s;
+	for (int i = 0; i < 4; i++)
+	{
+		uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		ctx->s[i] = z ^ (z >> 31);
+	}
+}
+
+void genrandjump(RandGenContext *ctx)
+{
+	static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+	uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int b = 0; b < 64; b++)
+		{
+			if (JUMP[i] & (static_cast<uint64_t> (1) << b))
+			{
+				s0 ^= ctx->s[0];
+				s1 ^= ctx->s[1];
+				s2 ^= ctx->s[2];
+				s3 ^= ctx->s[3];
+			}
+			genrandnext(ctx);
+		}
+	}
+	ctx->s[0] = s0;
+	ctx->s[1] = s1;
+	ctx->s[2] = s2;
+	ctx->s[3] = s3;
+}
+
+void genrandsubstream(const RandGenContext *ctx, unsigned int k, RandGenContext *result)
+{
+	*result = *ctx;
+	for (unsigned int i = 0; i < k; i++)
+		genrandjump(result);
 }
 
 double genrandreal(void)
 {
-    return static_cast<double> (rand()) / RAND_MAX;
+	return genrandreal(genranddefault());
+}
+
+double genrandreal(RandGenContext *ctx)
+{
+	/* the upper 53 bits give a uniform double in [0, 1) */
+	return static_cast<double> (genrandnext(ctx) >> 11) * (1.0 / 9007199254740992.0);
 }
 
 double genrandnormal(void)
 {
-	static double rand1, rand2;
-	double tmp = genrandreal();
-	while (tmp == 1.0)
-		tmp = genrandreal();
-    rand1 = -2 * log(1.0 - tmp);
-    rand2 = (1.0 - genrandreal()) * 6.2831853071795864769252866;
+	return genrandnormal(genranddefault());
+}
+
+double genrandnormal(RandGenContext *ctx)
+{
+	double rand1, rand2;
+	double tmp = genrandreal(ctx);
+	rand1 = -2 * log(1.0 - tmp);
+	rand2 = (1.0 - genrandreal(ctx)) * 6.2831853071795864769252866;
 	return sqrt(rand1) * cos(rand2);
 }
 
@@ -374,11 +374,8 @@ function elastic_mlogistic(f, y, timet; B=Union{}, df=20, max_itr=20,
                                  delta=delta);
             end
         else
-
-            for i = 1:N
-                gamma_new[:,i] = mlogit_warp_grad(alpha, beta, timet, q[:, i],
-                                                  Y[i, :], delt=delta);
-            end
+            gamma_new = mlogit_warp_grad_batch(alpha, beta, timet, q, Y,
+                                               delt=delta);
         end
 
         if norm(gamma-gamma_new) < 1e-5
@@ -195,6 +195,56 @@ function mlogit_warp_grad(alpha, beta, timet, q, y; max_itr=8000,
 end
 
 
+"""
+Calculate m-logistic warping for all observations using gradient method
+
+    mlogit_warp_grad_batch(alpha, beta, timet, q, Y; max_itr=8000, tol=1e-10,
+                           delt=0.008, display=0, step=0, nthreads=0)
+    :param alpha: intercept
+    :param beta: regression function, its columns are normalized in place as
+                 by mlogit_warp_grad
+    :param timet: vector describing time samples
+    :param q: srsf (M,N)
+    :param Y: response matrix (N,m)
+    :param max_itr: maximum number of iterations
+    :param tol: stopping tolerance
+    :param delt: gradient step size
+    :param display: display optimization iterations
+    :param step: step rule (0 fixed delt, 1 Armijo backtracking,
+                 2 Barzilai-Borwein with Armijo safeguard)
+    :param nthreads: number of native threads (0 uses all)
+
+    :return gamout: warping functions (M,N)
+"""
+function mlogit_warp_grad_batch(alpha, beta, timet, q, Y; max_itr=8000,
+                                tol=1e-10, delt=0.008, display=0, step=0,
+                                nthreads=0)
+    m1, N = size(q);
+    m = size(beta,2);
+    q1 = zeros(m1, N);
+    for i in 1:N
+        q1[:, i] = q[:, i] / norm(q[:, i]);
+    end
+    alpha /= norm(alpha);
+    for i in 1:m
+        beta[:, i] = beta[:, i] / norm(beta[:, i]);
+    end
+    gam1 = repeat(collect(LinRange(0, 1, m1)), 1, N);
+    gamout = zeros(m1, N);
+    y = convert(Matrix{Int32}, permutedims(Y));
+
+    ccall((:mlogit_warp_grad_batch, libfdasrsf), Cvoid,
+          (Ref{Int32}, Ref{Int32}, Ref{Int32}, Ptr{Float64}, Ptr{Float64},
+          Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Ptr{Int32}, Ref{Int32},
+          Ref{Float64}, Ref{Float64}, Ref{Int32}, Ref{Int32}, Ref{Int32},
+          Ptr{Float64}),
+          m1, m, N, alpha, beta, timet, gam1, q1, y, max_itr, tol, delt,
+          display, step, nthreads, gamout)
+
+    return gamout
+end
+
+
 """
 Calculate warping for m-logistic elastic regression
 